@@ -1,103 +1,157 @@
-#include <algorithm>
+#pragma once
+#include <array>
+#include <cstddef>
 #include <iterator>
-#include <map>
-#include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <std_compat/optional.h>
 
-class Trie
+/**
+ * one node of a basic_flat_trie; children are linked through first_child and
+ * next_sibling, where 0 (the root) means none
+ */
+struct trie_node {
+  char character = '\0';
+  size_t first_child = 0;
+  size_t next_sibling = 0;
+  size_t id = static_cast<size_t>(-1);
+};
+
+/**
+ * a trie stored in one contiguous array of nodes.
+ *
+ * Each node records the candidate that is the only one to pass through it, or
+ * npos if several do.  With std::array storage the trie can be built constexpr.
+ */
+template <class Nodes>
+class basic_flat_trie
 {
 public:
-  Trie()
-    : root(std::make_shared<TrieNode>(std::weak_ptr<TrieNode>()))
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  constexpr explicit basic_flat_trie(Nodes storage)
+    : nodes(std::move(storage))
   {}
+
   template <class ForwardIt>
-  Trie(ForwardIt begin_it, ForwardIt end_it)
-    : Trie()
+  constexpr void insert(ForwardIt begin_it, ForwardIt end_it)
   {
-    std::for_each(begin_it, end_it,
-                  [this](auto const& candidate) { this->insert(candidate); });
+    for (; begin_it != end_it; ++begin_it) {
+      insert(std::string_view(*begin_it));
+    }
   }
 
-  void insert(std::string const& to_insert)
+  constexpr void insert(std::string_view to_insert)
   {
-    size_t last_id = Trie::ambiguous;
-    std::shared_ptr<TrieNode> current = root;
+    size_t current = 0;
+    bool created = false;
     for (char character : to_insert) {
-      if (!current->has_any_child() && last_id==Trie::ambiguous && current != root) {
-        throw std::logic_error("two more more keys are completely ambiguous");
-      } else { 
-        if(current->get_id() != max_id) current->set_id(Trie::ambiguous);
-        if (current->has_child(character)) {
-          current = current->get_child(character);
-        } else {
-          current = current->create_child(character, max_id);
-          last_id = max_id;
+      if (!created) {
+        if (nodes[current].first_child == 0 && current != 0) {
+          throw std::logic_error("two more more keys are completely ambiguous");
         }
+        nodes[current].id = npos;
       }
+      size_t next = created ? 0 : child(current, character);
+      if (next == 0) {
+        next = add_child(current, character, num_keys);
+        created = true;
+      }
+      current = next;
     }
-    if(last_id == Trie::ambiguous) throw std::logic_error("two more more keys are completely ambiguous");
-    max_id++;
+    if (!created) throw std::logic_error("two more more keys are completely ambiguous");
+    num_keys++;
   }
 
-  compat::optional<size_t> find(std::string const& to_match) { 
-    std::shared_ptr<TrieNode> current = root;
-
-    for (auto character : to_match) {
-      if(!current->has_child(character)) return compat::nullopt;
-      current = current->get_child(character);
-      if(current->get_id() != ambiguous) return current->get_id();
+  /**
+   * the candidate that text unambiguously names, or npos
+   */
+  constexpr size_t find(std::string_view to_match) const
+  {
+    size_t current = 0;
+    for (char character : to_match) {
+      current = child(current, character);
+      if (current == 0) return npos;
+      if (nodes[current].id != npos) return nodes[current].id;
     }
-    return compat::nullopt;
+    return npos;
   }
 
+  constexpr size_t size() const { return num_keys; }
+
 private:
-  class TrieNode : public std::enable_shared_from_this<TrieNode>
+  constexpr size_t child(size_t parent, char character) const
   {
-  public:
-    TrieNode(std::weak_ptr<TrieNode> parent, char character = '\0',
-             size_t id = -1)
-      : parent(parent)
-      , character(character)
-      , id(id)
-    {}
-    bool has_child(char character) const
-    {
-      return children.find(character) != children.end();
-    }
-    bool has_any_child() const {
-      return not children.empty();
-    }
-    std::shared_ptr<TrieNode> get_child(char character) const
-    {
-      return children.find(character)->second;
-    }
-    std::shared_ptr<TrieNode> create_child(char character, size_t id = -1)
-    {
-      return children[character] =
-               std::make_shared<TrieNode>(weak_from_this(), character, id);
-    }
-    size_t get_id() {
-      return id;
+    for (size_t c = nodes[parent].first_child; c != 0; c = nodes[c].next_sibling) {
+      if (nodes[c].character == character) return c;
     }
+    return 0;
+  }
 
+  constexpr size_t add_child(size_t parent, char character, size_t id)
+  {
+    if (num_nodes >= nodes.size()) throw std::logic_error("trie capacity exceeded");
+    size_t node = num_nodes++;
+    nodes[node].character = character;
+    nodes[node].id = id;
+    nodes[node].next_sibling = nodes[parent].first_child;
+    nodes[parent].first_child = node;
+    return node;
+  }
 
-  private:
-    void set_id(size_t id) {
-      this->id = id;
-    }
+  Nodes nodes;
+  size_t num_nodes = 1;
+  size_t num_keys = 0;
+};
 
-    std::weak_ptr<TrieNode> parent;
-    std::map<char, std::shared_ptr<TrieNode>> children;
-    char character;
-    size_t id;
-    friend Trie;
-  };
+template <size_t Capacity>
+using flat_trie = basic_flat_trie<std::array<trie_node, Capacity>>;
 
-  static const size_t ambiguous = -1;
-  size_t max_id = 0;
-  std::shared_ptr<TrieNode> root;
-};
+/**
+ * the number of nodes a trie of candidates needs at most
+ */
+template <class ForwardIt>
+constexpr size_t trie_capacity(ForwardIt begin_it, ForwardIt end_it)
+{
+  size_t capacity = 1;
+  for (; begin_it != end_it; ++begin_it) {
+    capacity += std::string_view(*begin_it).size();
+  }
+  return capacity;
+}
+
+template <class Container>
+constexpr size_t trie_capacity(Container const& candidates)
+{
+  return trie_capacity(std::begin(candidates), std::end(candidates));
+}
+
+/**
+ * builds a fixed capacity trie, use with trie_capacity(candidates) in a
+ * constexpr context so that ambiguous tables fail to compile
+ */
+template <size_t Capacity, class Container>
+constexpr flat_trie<Capacity> make_flat_trie(Container const& candidates)
+{
+  flat_trie<Capacity> trie{std::array<trie_node, Capacity>{}};
+  trie.insert(std::begin(candidates), std::end(candidates));
+  return trie;
+}
+
+/**
+ * fuzzy matches text against the longest unique prefixes of a prebuilt trie
+ */
+template <class Nodes>
+compat::optional<size_t>
+fuzzy_match(std::string_view text, basic_flat_trie<Nodes> const& candidates)
+{
+  size_t id = candidates.find(text);
+  if (id == basic_flat_trie<Nodes>::npos) return compat::nullopt;
+  return id;
+}
 
 /**
  * fuzzy matches text against the longest unique given set of candidates
@@ -107,6 +161,7 @@ template <class ForwardIterator>
 compat::optional<size_t>
 fuzzy_match(std::string const& text, ForwardIterator begin_it, ForwardIterator end_it)
 {
-  Trie candidates(begin_it, end_it);
-  return candidates.find(text);
+  basic_flat_trie<std::vector<trie_node>> candidates(std::vector<trie_node>(trie_capacity(begin_it, end_it)));
+  candidates.insert(begin_it, end_it);
+  return fuzzy_match(text, candidates);
 }
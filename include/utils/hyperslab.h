@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <std_compat/optional.h>
+
+/**
+ * one dimension of a user provided hyperslab, missing bounds default to the
+ * extent of the dimension
+ */
+struct hyperslab_range {
+  compat::optional<size_t> begin;
+  compat::optional<size_t> end;
+};
+
+/**
+ * a resolved hyperslab: count[i] entries starting at start[i] along dimension i
+ */
+struct hyperslab {
+  std::vector<size_t> start;
+  std::vector<size_t> count;
+};
+
+/**
+ * parses a comma separated list of half-open ranges like "0:10,:,5:"
+ * listed fastest dimension first
+ */
+inline std::vector<hyperslab_range> parse_hyperslab(std::string const& spec) {
+  std::vector<hyperslab_range> ranges;
+  size_t pos = 0;
+  auto parse_bound = [&spec](std::string const& bound) -> compat::optional<size_t> {
+    if(bound.empty()) return compat::nullopt;
+    size_t used = 0;
+    size_t value = std::stoull(bound, &used);
+    if(used != bound.size()) throw std::invalid_argument("invalid hyperslab: " + spec);
+    return value;
+  };
+  while(pos <= spec.size()) {
+    auto comma = std::min(spec.find(',', pos), spec.size());
+    std::string range = spec.substr(pos, comma - pos);
+    auto colon = range.find(':');
+    if(colon == std::string::npos) throw std::invalid_argument("invalid hyperslab: " + spec);
+    ranges.push_back({parse_bound(range.substr(0, colon)), parse_bound(range.substr(colon + 1))});
+    pos = comma + 1;
+  }
+  return ranges;
+}
+
+/**
+ * resolves user provided ranges against the dimensions of a dataset; dimensions
+ * without a range are selected in full
+ */
+inline hyperslab resolve_hyperslab(std::vector<hyperslab_range> const& ranges, std::vector<size_t> const& dims) {
+  if(ranges.size() > dims.size()) {
+    throw std::out_of_range("hyperslab has more ranges than the data has dimensions");
+  }
+  hyperslab slab;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    size_t begin = (i < ranges.size() && ranges[i].begin) ? *ranges[i].begin : 0;
+    size_t end = (i < ranges.size() && ranges[i].end) ? *ranges[i].end : dims[i];
+    if(begin >= end || end > dims[i]) {
+      throw std::out_of_range("hyperslab range " + std::to_string(begin) + ":" + std::to_string(end) +
+          " is empty or exceeds dimension " + std::to_string(i) + " of size " + std::to_string(dims[i]));
+    }
+    slab.start.push_back(begin);
+    slab.count.push_back(end - begin);
+  }
+  return slab;
+}
+
+/**
+ * the number of entries along the slowest dimension in each of parts pieces
+ * of an extent long dimension; the last pieces may be shorter or empty
+ */
+inline size_t partition_extent(size_t extent, size_t parts) {
+  return (parts == 0) ? extent : (extent + parts - 1) / parts;
+}
+
+/**
+ * piece part of parts of slab when split along its slowest (last) dimension
+ */
+inline hyperslab partition_hyperslab(hyperslab const& slab, size_t part, size_t parts) {
+  hyperslab piece = slab;
+  if(slab.count.empty()) return piece;
+  const size_t slowest = slab.count.back();
+  const size_t extent = partition_extent(slowest, parts);
+  const size_t begin = std::min(slowest, part * extent);
+  piece.start.back() += begin;
+  piece.count.back() = std::min(slowest, begin + extent) - begin;
+  return piece;
+}
+
+/**
+ * copies a count sized box of elem_size elements from src at src_start to dst
+ * at dst_start where both buffers are stored fastest dimension first
+ */
+inline void copy_hyperslab(void const* src, std::vector<size_t> const& src_dims, std::vector<size_t> const& src_start,
+    void* dst, std::vector<size_t> const& dst_dims, std::vector<size_t> const& dst_start,
+    std::vector<size_t> const& count, size_t elem_size) {
+  const size_t ndims = count.size();
+  if(ndims == 0 || std::find(count.begin(), count.end(), 0) != count.end()) return;
+  auto offset_of = [ndims](std::vector<size_t> const& dims, std::vector<size_t> const& start, std::vector<size_t> const& index) {
+    size_t offset = 0;
+    for (size_t i = ndims; i-- > 0;) {
+      offset = offset * dims[i] + start[i] + index[i];
+    }
+    return offset;
+  };
+  const size_t row_bytes = count[0] * elem_size;
+  std::vector<size_t> index(ndims, 0);
+  while(true) {
+    std::memcpy(static_cast<char*>(dst) + offset_of(dst_dims, dst_start, index) * elem_size,
+        static_cast<char const*>(src) + offset_of(src_dims, src_start, index) * elem_size,
+        row_bytes);
+    size_t dim = 1;
+    for (; dim < ndims; ++dim) {
+      if(++index[dim] < count[dim]) break;
+      index[dim] = 0;
+    }
+    if(dim == ndims) break;
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <libpressio_ext/cpp/options.h>
+
+/**
+ * a flat index of a configurable's options built from one get_options call.
+ *
+ * keys and their types are resolved once, and the index tracks the value of
+ * each key so reconfiguring only needs to set the keys that changed.  The
+ * index assumes it sees every set_options call made on the configurable.
+ */
+class option_index {
+  public:
+  option_index()=default;
+  explicit option_index(pressio_options const& options);
+
+  /** true once the index has been built from a configurable's options */
+  bool indexed() const { return built; }
+
+  /** pressio_options_key_does_not_exist if key is not an option of the configurable */
+  pressio_options_key_status key_status(std::string const& key) const;
+
+  /** the type of key, or pressio_option_unset_type if it does not exist */
+  pressio_option_type type(std::string const& key) const;
+
+  /**
+   * converts value to the type of key and stores it in out; returns the same
+   * statuses as pressio_options::cast_set
+   */
+  pressio_options_key_status cast(std::string const& key, pressio_option const& value, pressio_option& out,
+      pressio_conversion_safety safety = pressio_conversion_special) const;
+
+  /** the entries of desired whose values differ from the indexed values */
+  pressio_options changed(pressio_options const& desired) const;
+
+  /** records that options were applied to the configurable */
+  void update(pressio_options const& options);
+
+  private:
+  std::unordered_map<std::string, pressio_option> values;
+  bool built = false;
+};
+
+/**
+ * sets every entry of desired and records them; returns the result of set_options.
+ *
+ * set_options is not idempotent for every plugin, so the first application of a
+ * configuration uses this rather than apply_changed_options
+ */
+template <class Configurable>
+int apply_options(Configurable& c, pressio_options const& desired, option_index& index) {
+  int rc = c.set_options(desired);
+  if(rc == 0) index.update(desired);
+  return rc;
+}
+
+/**
+ * sets the entries of desired that changed since the index was last updated and
+ * records them; returns the result of set_options or 0 if nothing changed
+ */
+template <class Configurable>
+int apply_changed_options(Configurable& c, pressio_options const& desired, option_index& index) {
+  pressio_options changes = index.changed(desired);
+  if(changes.size() == 0) return 0;
+  int rc = c.set_options(changes);
+  if(rc == 0) index.update(changes);
+  return rc;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/compressor.h>
+
+#include "bench.h"
+#include "options.h"
+#include "serve.h"
+
+namespace {
+
+struct bench_result {
+  std::string input;
+  std::string phase;
+  size_t bytes;
+  double min_ms;
+  double median_ms;
+  double p99_ms;
+};
+
+void check(pressio_compressor& compressor, int rc) {
+  if(rc) {
+    if(rank == 0) {
+      std::cerr << compressor->error_msg() << std::endl;
+    }
+    tool_exit(compressor->error_code());
+  }
+}
+
+template <class Func>
+std::vector<double> time_samples(size_t warmup, size_t iterations, Func&& func) {
+  for (size_t i = 0; i < warmup; ++i) {
+    func();
+  }
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  for (size_t i = 0; i < iterations; ++i) {
+    auto begin = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    samples.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+  }
+  return samples;
+}
+
+bench_result summarize(std::string input, std::string phase, size_t bytes, std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  //nearest-rank percentiles
+  auto percentile = [&samples](double p) {
+    size_t nearest = static_cast<size_t>(std::ceil(p * samples.size()));
+    return samples[std::max<size_t>(nearest, 1) - 1];
+  };
+  return bench_result{std::move(input), std::move(phase), bytes, samples.front(), percentile(.5), percentile(.99)};
+}
+
+double gb_per_sec(size_t bytes, double ms) {
+  return (ms > 0) ? bytes / (ms * 1e6) : 0;
+}
+
+void print_human(std::vector<bench_result> const& results) {
+  const auto precision = std::cout.precision();
+  std::cout << std::left << std::setw(8) << "input" << std::setw(12) << "phase"
+    << std::right << std::setw(12) << "min_ms" << std::setw(12) << "median_ms" << std::setw(12) << "p99_ms"
+    << std::setw(12) << "GB/s" << std::endl;
+  for (auto const& r : results) {
+    std::cout << std::left << std::setw(8) << r.input << std::setw(12) << r.phase
+      << std::right << std::fixed << std::setprecision(3)
+      << std::setw(12) << r.min_ms << std::setw(12) << r.median_ms << std::setw(12) << r.p99_ms
+      << std::setw(12) << gb_per_sec(r.bytes, r.median_ms) << std::endl;
+  }
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout.precision(precision);
+}
+
+void print_json(std::vector<bench_result> const& results, size_t warmup, size_t iterations) {
+  std::cout << "{\"warmup\":" << warmup << ",\"iterations\":" << iterations << ",\"results\":[";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto const& r = results[i];
+    std::cout << ((i == 0) ? "" : ",")
+      << "{\"input\":\"" << r.input << "\",\"phase\":\"" << r.phase << "\",\"bytes\":" << r.bytes
+      << ",\"min_ms\":" << r.min_ms << ",\"median_ms\":" << r.median_ms << ",\"p99_ms\":" << r.p99_ms
+      << ",\"min_gbps\":" << gb_per_sec(r.bytes, r.p99_ms) << ",\"median_gbps\":" << gb_per_sec(r.bytes, r.median_ms)
+      << ",\"max_gbps\":" << gb_per_sec(r.bytes, r.min_ms) << "}";
+  }
+  std::cout << "]}" << std::endl;
+}
+
+}
+
+void bench(pressio_compressor& compressor, cmdline_options const& opts) {
+  if(opts.input.empty()) {
+    if(rank == 0) {
+      std::cerr << "bench requires at least one input" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+  const size_t warmup = opts.bench_warmup;
+  const size_t iterations = std::max<size_t>(opts.bench_iterations, 1);
+  std::vector<bench_result> results;
+
+  //the buffers are allocated once so that only the compressor is timed
+  std::vector<pressio_data> compressed, decompressed;
+  for (auto const& input : opts.input) {
+    compressed.emplace_back(pressio_data::empty(pressio_byte_dtype, {}));
+    decompressed.emplace_back(pressio_data::owning(input.dtype(), input.dimensions()));
+  }
+
+  for (size_t i = 0; i < opts.input.size(); ++i) {
+    auto const& input = opts.input[i];
+    const size_t bytes = input.size_in_bytes();
+    results.emplace_back(summarize(std::to_string(i), "compress", bytes,
+          time_samples(warmup, iterations, [&]{ check(compressor, compressor->compress(&input, &compressed[i])); })));
+    if(warmup == 0) {
+      //decompression needs a compressed buffer even without warmup iterations
+      check(compressor, compressor->compress(&input, &compressed[i]));
+    }
+    results.emplace_back(summarize(std::to_string(i), "decompress", bytes,
+          time_samples(warmup, iterations, [&]{ check(compressor, compressor->decompress(&compressed[i], &decompressed[i])); })));
+  }
+
+  if(opts.input.size() > 1) {
+    std::vector<const pressio_data*> input_ptrs, compressed_cptrs;
+    std::vector<pressio_data*> compressed_ptrs, decompressed_ptrs;
+    for (size_t i = 0; i < opts.input.size(); ++i) {
+      input_ptrs.emplace_back(&opts.input[i]);
+      compressed_cptrs.emplace_back(&compressed[i]);
+      compressed_ptrs.emplace_back(&compressed[i]);
+      decompressed_ptrs.emplace_back(&decompressed[i]);
+    }
+    const size_t bytes = std::accumulate(opts.input.begin(), opts.input.end(), size_t{0},
+        [](size_t total, pressio_data const& d) { return total + d.size_in_bytes(); });
+    results.emplace_back(summarize("all", "compress", bytes,
+          time_samples(warmup, iterations, [&]{
+            check(compressor, compressor->compress_many(
+                input_ptrs.data(), input_ptrs.data() + input_ptrs.size(),
+                compressed_ptrs.data(), compressed_ptrs.data() + compressed_ptrs.size()));
+            })));
+    results.emplace_back(summarize("all", "decompress", bytes,
+          time_samples(warmup, iterations, [&]{
+            check(compressor, compressor->decompress_many(
+                compressed_cptrs.data(), compressed_cptrs.data() + compressed_cptrs.size(),
+                decompressed_ptrs.data(), decompressed_ptrs.data() + decompressed_ptrs.size()));
+            })));
+  }
+
+  if(rank != 0) return;
+  switch(opts.format) {
+    case OutputFormat::Human:
+      print_human(results);
+      break;
+    case OutputFormat::JSON:
+      print_json(results, warmup, iterations);
+      break;
+  }
+}
@@ -0,0 +1,12 @@
+#ifndef BENCH_H_R8KQ2WZN
+#define BENCH_H_R8KQ2WZN
+#include <libpressio_ext/cpp/compressor.h>
+#include "cmdline.h"
+
+/**
+ * times compression and decompression of the already loaded inputs in process
+ * and reports min/median/p99 latency and throughput for each phase and input
+ */
+void bench(pressio_compressor& compressor, cmdline_options const& opts);
+
+#endif /* end of include guard: BENCH_H_R8KQ2WZN */
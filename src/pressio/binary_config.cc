@@ -0,0 +1,241 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <libpressio_ext/cpp/data.h>
+#include "binary_config.h"
+#include "mapped.h"
+
+namespace {
+const char config_magic[8] = {'P','R','E','S','S','I','O','O'};
+const uint32_t config_version = 1;
+const std::string config_extension = ".pcfg";
+
+uint64_t fnv1a(const char* data, size_t size) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <class T>
+void write_pod(std::ostream& out, T const& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write_string(std::ostream& out, std::string const& value) {
+  write_pod(out, static_cast<uint64_t>(value.size()));
+  out.write(value.data(), value.size());
+}
+
+class byte_cursor {
+  public:
+  byte_cursor(const char* begin, size_t size): pos(begin), end(begin + size) {}
+
+  template <class T>
+  T read() {
+    T value;
+    require(sizeof(T));
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+  std::string read_string() {
+    auto size = read<uint64_t>();
+    require(size);
+    std::string value(pos, size);
+    pos += size;
+    return value;
+  }
+  /**
+   * reads an element count, checking that the remaining bytes could hold that
+   * many elements of at least element_size bytes before anything is allocated
+   */
+  uint64_t read_count(size_t element_size) {
+    auto count = read<uint64_t>();
+    if(count > static_cast<size_t>(end - pos) / element_size) {
+      throw std::runtime_error("truncated binary configuration");
+    }
+    return count;
+  }
+  const char* read_bytes(size_t size) {
+    require(size);
+    const char* bytes = pos;
+    pos += size;
+    return bytes;
+  }
+  void require(size_t n) const {
+    if(static_cast<size_t>(end - pos) < n) {
+      throw std::runtime_error("truncated binary configuration");
+    }
+  }
+
+  private:
+  const char* pos;
+  const char* end;
+};
+
+/** returns false if option cannot be serialized */
+bool write_option(std::ostream& out, pressio_option const& option) {
+  if(!option.has_value()) return false;
+  const auto type = option.type();
+  switch(type) {
+    case pressio_option_int8_type: write_pod(out, type); write_pod(out, option.get_value<int8_t>()); return true;
+    case pressio_option_uint8_type: write_pod(out, type); write_pod(out, option.get_value<uint8_t>()); return true;
+    case pressio_option_int16_type: write_pod(out, type); write_pod(out, option.get_value<int16_t>()); return true;
+    case pressio_option_uint16_type: write_pod(out, type); write_pod(out, option.get_value<uint16_t>()); return true;
+    case pressio_option_int32_type: write_pod(out, type); write_pod(out, option.get_value<int32_t>()); return true;
+    case pressio_option_uint32_type: write_pod(out, type); write_pod(out, option.get_value<uint32_t>()); return true;
+    case pressio_option_int64_type: write_pod(out, type); write_pod(out, option.get_value<int64_t>()); return true;
+    case pressio_option_uint64_type: write_pod(out, type); write_pod(out, option.get_value<uint64_t>()); return true;
+    case pressio_option_float_type: write_pod(out, type); write_pod(out, option.get_value<float>()); return true;
+    case pressio_option_double_type: write_pod(out, type); write_pod(out, option.get_value<double>()); return true;
+    case pressio_option_bool_type: write_pod(out, type); write_pod(out, static_cast<uint8_t>(option.get_value<bool>())); return true;
+    case pressio_option_dtype_type: write_pod(out, type); write_pod(out, static_cast<int32_t>(option.get_value<pressio_dtype>())); return true;
+    case pressio_option_threadsafety_type: write_pod(out, type); write_pod(out, static_cast<int32_t>(option.get_value<pressio_thread_safety>())); return true;
+    case pressio_option_charptr_type:
+      write_pod(out, type);
+      write_string(out, option.get_value<std::string>());
+      return true;
+    case pressio_option_charptr_array_type:
+      {
+        auto const& values = option.get_value<std::vector<std::string>>();
+        write_pod(out, type);
+        write_pod(out, static_cast<uint64_t>(values.size()));
+        for (auto const& value : values) {
+          write_string(out, value);
+        }
+      }
+      return true;
+    case pressio_option_data_type:
+      {
+        auto const& data = option.get_value<pressio_data>();
+        write_pod(out, type);
+        write_pod(out, static_cast<int32_t>(data.dtype()));
+        write_pod(out, static_cast<uint64_t>(data.num_dimensions()));
+        for (auto dim : data.dimensions()) {
+          write_pod(out, static_cast<uint64_t>(dim));
+        }
+        write_pod(out, static_cast<uint64_t>(data.size_in_bytes()));
+        out.write(static_cast<const char*>(data.data()), data.size_in_bytes());
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+pressio_option read_option(byte_cursor& in) {
+  switch(in.read<pressio_option_type>()) {
+    case pressio_option_int8_type: return in.read<int8_t>();
+    case pressio_option_uint8_type: return in.read<uint8_t>();
+    case pressio_option_int16_type: return in.read<int16_t>();
+    case pressio_option_uint16_type: return in.read<uint16_t>();
+    case pressio_option_int32_type: return in.read<int32_t>();
+    case pressio_option_uint32_type: return in.read<uint32_t>();
+    case pressio_option_int64_type: return in.read<int64_t>();
+    case pressio_option_uint64_type: return in.read<uint64_t>();
+    case pressio_option_float_type: return in.read<float>();
+    case pressio_option_double_type: return in.read<double>();
+    case pressio_option_bool_type: return static_cast<bool>(in.read<uint8_t>());
+    case pressio_option_dtype_type: return static_cast<pressio_dtype>(in.read<int32_t>());
+    case pressio_option_threadsafety_type: return static_cast<pressio_thread_safety>(in.read<int32_t>());
+    case pressio_option_charptr_type: return in.read_string();
+    case pressio_option_charptr_array_type:
+      {
+        //each string is at least its length
+        std::vector<std::string> values(in.read_count(sizeof(uint64_t)));
+        for (auto& value : values) {
+          value = in.read_string();
+        }
+        return values;
+      }
+    case pressio_option_data_type:
+      {
+        auto dtype = static_cast<pressio_dtype>(in.read<int32_t>());
+        std::vector<size_t> dims(in.read_count(sizeof(uint64_t)));
+        for (auto& dim : dims) {
+          dim = in.read<uint64_t>();
+        }
+        auto size = in.read<uint64_t>();
+        return pressio_data::copy(dtype, in.read_bytes(size), dims);
+      }
+    default:
+      throw std::runtime_error("unsupported option type in binary configuration");
+  }
+}
+
+}
+
+bool is_binary_config_path(std::string const& path) {
+  return path.size() >= config_extension.size() &&
+    path.compare(path.size() - config_extension.size(), config_extension.size(), config_extension) == 0;
+}
+
+void save_binary_config(std::string const& path, binary_config const& config) {
+  uint64_t count = 0;
+  std::ostringstream entries;
+  for (auto const& entry : config.options) {
+    std::ostringstream value;
+    if(!write_option(value, entry.second)) continue;
+    write_string(entries, entry.first);
+    entries << value.str();
+    ++count;
+  }
+  std::ostringstream body;
+  write_pod(body, count);
+  body << entries.str();
+  const std::string bytes = body.str();
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(config_magic, sizeof(config_magic));
+  write_pod(out, config_version);
+  write_string(out, config.compressor_id);
+  write_string(out, config.compressor_version);
+  write_string(out, config.libpressio_version);
+  write_pod(out, fnv1a(bytes.data(), bytes.size()));
+  write_pod(out, static_cast<uint64_t>(bytes.size()));
+  out.write(bytes.data(), bytes.size());
+  if(!out) {
+    throw std::runtime_error("failed to write " + path);
+  }
+}
+
+compat::optional<binary_config> load_binary_config(std::string const& path) {
+  {
+    char magic[sizeof(config_magic)];
+    std::ifstream in(path, std::ios::binary);
+    if(!in.read(magic, sizeof(magic)) || std::memcmp(magic, config_magic, sizeof(magic)) != 0) {
+      return compat::nullopt;
+    }
+  }
+  pressio_data file = map_input_file(path, compat::nullopt, {}, MapHint::None);
+  byte_cursor header(static_cast<const char*>(file.data()), file.size_in_bytes());
+  header.read_bytes(sizeof(config_magic));
+  auto version = header.read<uint32_t>();
+  if(version != config_version) {
+    throw std::runtime_error("unsupported binary configuration version " + std::to_string(version));
+  }
+  binary_config config;
+  config.compressor_id = header.read_string();
+  config.compressor_version = header.read_string();
+  config.libpressio_version = header.read_string();
+  auto hash = header.read<uint64_t>();
+  auto size = header.read<uint64_t>();
+  const char* bytes = header.read_bytes(size);
+  if(fnv1a(bytes, size) != hash) {
+    throw std::runtime_error("corrupt binary configuration " + path);
+  }
+
+  byte_cursor body(bytes, size);
+  auto count = body.read<uint64_t>();
+  for (uint64_t i = 0; i < count; ++i) {
+    auto key = body.read_string();
+    config.options.set(key, read_option(body));
+  }
+  return config;
+}
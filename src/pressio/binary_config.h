@@ -0,0 +1,38 @@
+#ifndef BINARY_CONFIG_H_U3HD8RLM
+#define BINARY_CONFIG_H_U3HD8RLM
+#include <string>
+#include <libpressio_ext/cpp/options.h>
+#include <std_compat/optional.h>
+
+/**
+ * a configuration saved with -a save to a path ending in .pcfg
+ *
+ * the file is a header recording what produced the configuration followed by
+ * the options, each as its key, type, and value in native byte order, and a
+ * hash of the options that is checked on load
+ */
+struct binary_config {
+  std::string compressor_id;
+  std::string compressor_version;
+  std::string libpressio_version;
+  pressio_options options;
+};
+
+/**
+ * true if -a save should write a binary configuration to path
+ */
+bool is_binary_config_path(std::string const& path);
+
+/**
+ * writes config to path; options without a value or holding user pointers
+ * are skipped since they cannot be restored; throws on failure
+ */
+void save_binary_config(std::string const& path, binary_config const& config);
+
+/**
+ * maps and decodes the configuration at path, or returns nullopt if path is
+ * not a binary configuration; throws if it is corrupt
+ */
+compat::optional<binary_config> load_binary_config(std::string const& path);
+
+#endif /* end of include guard: BINARY_CONFIG_H_U3HD8RLM */
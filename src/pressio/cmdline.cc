@@ -1,7 +1,10 @@
 #include "cmdline.h"
+#include <array>
 #include <iostream>
 #include <memory>
 #include <std_compat/optional.h>
+#include <sstream>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include <unistd.h>
@@ -21,6 +24,11 @@
 #include "utils/string_options.h"
 #include "utils/pressio_tools_version.h"
 #include "options.h"
+#include "container.h"
+#include "hyperslab_io.h"
+#include "mapped.h"
+#include "input_list.h"
+#include "serve.h"
 
 #if LIBPRESSIO_TOOLS_HAS_MPI
 #include <mpi.h>
@@ -55,29 +63,42 @@ usage()
   if(cmdline_rank == 0) {
     std::cerr << R"(pressio [args] [compressor]
 operations:
--a <action> the actions to preform: compress, decompress, version, settings, load, save, graph help default=compress+decompress
+-a <action> the actions to preform: compress, decompress, version, settings, load, save, graph, profile-graph, stream-compress, bench, serve, watch help default=compress+decompress
 -Q enable fully-qualified mode, this will change the names of options for compressors
 -j enable JSON output mode
+-v print how long each step of starting up took: plugin registration, -D libraries, argument parsing, compressor setup
 -D <plugin.so> open plugin
--g <graph_mode> format to print the module graph {graphviz, d2}
--l <config_file> the configuration file to load/save
+-g <graph_mode> format to print the module graph {graphviz, d2, json}; profile-graph also accepts folded for flamegraph.pl
+-V label each module of the graph with its options
+-l <config_file> the configuration file to load/save; paths ending in .pcfg are saved in a binary format that loads without parsing JSON
+-A <address> for serve, a Unix socket to listen on, a script file, or - for stdin (default); each line is the arguments of one pressio invocation
+-B [<warmup>:]<iterations> iterations to time for bench after the warmup iterations, defaults 1:10
+-P with MPI, each rank reads and compresses only its slab of each input along the slowest dimension; the slabs are written collectively as the blocks of one container (-w) and decompressed in place into one raw file (-W)
+-q <depth> pipeline reading, compressing, and writing of the inputs (-p) with at most depth inputs queued between stages
+-H low memory mode, process each input (-p) end to end and free its buffers before reading the next; metrics are printed for each input, labeled with its path or index
+-J <threads> compress and decompress independent inputs (-p) concurrently on this many threads, each input on one thread so that its metrics are printed separately, defaults 1
+-a watch -i <directory>/<pattern> compresses each file matching the shell pattern once it is completely written to the directory (closed after writing or moved into it) using one compressor; each output is written as <file>.pressio next to it or into the directory given by -w, up to -J files are compressed at once and at most -q more wait for a thread; runs until SIGINT or SIGTERM
+-c <chunk> number of entries along the slowest dimension per block for stream-compress and container outputs
 
 input datasets:
 -d <dim> dimension of the dataset
 -t <pressio_type> type of the dataset
--i <input_file> path to the input file
+-i <input_file> path to the input file, or shm:<name> to attach a POSIX shared memory segment in place, described by -t and -d
 -I <dataset> treat the file as HDF5 and read this dataset
 -u <option>=<value> pass the specified option to the generic IO plugin for the input (uncompressed) file
 -G <option>=<value> pass the specified option to the generic IO plugin for the input (uncompressed) file early
 -U <option_key> prints this option after setting it, defaults none, "all" prints all options for the input (uncompressed) file
 -T <format> set the input format
+-x <begin>:<end>,... only read this region of the input, fastest dimension first; supported for raw binary and HDF5 inputs
+-L <mode> how to load a raw binary input: read (default), mmap maps it without a copy, populate/willneed/sequential also map it with that paging hint
 
 -p indicates that all subsequent input dataset arguments are for the "next buffer"
+-K <manifest> one input per line as key=value fields: input, dtype, dims=<d0>,<d1>,..., format, compressed, compressed_format, decompressed, decompressed_format; the preceding arguments of the group are the defaults for each line, and each input is read right before it is compressed as with -H unless -q is given
 
 output datasets:
 
--f <format> compressed file format
--w <compressed_file> use POSIX if format is not set
+-f <format> compressed file format, "container" writes a self-describing chunked container
+-w <compressed_file> use POSIX if format is not set, shm:<name> publishes the compressed buffer as a POSIX shared memory segment
 -s <compressed_file_dataset> use HDF output for the compressed file
 -y <option>=<value> pass the specified option to the generic IO plugin for the compressed file
 -e <option>=<value> pass the specified option to the generic IO plugin for the compressed file early
@@ -85,11 +106,13 @@ output datasets:
 -k <num> number of compressed data datasets to pass to compress, defaults to the number of "-p" flags passed + 1
 
 -F <format> decompressed file format
--W <decompressed_file> use POSIX if format is not set
+-W <decompressed_file> use POSIX if format is not set, shm:<name> decompresses directly into a POSIX shared memory segment
 -S <decompressed_file_dataset> use HDF output for the decompressed file
 -Y <option>=<value> pass the specified option to the generic IO plugin for the decompressed file
 -E <option>=<value> pass the specified option to the generic IO plugin for the decompressed file early
 -Z <option_key> prints this option after setting it, defaults none, "all" prints all options for the decompressed file
+-X <mode> how to store the decompressed file: write (default) through the io plugin, or mmap to decompress directly into a memory mapped -W file
+-R <begin>:<end>,... only decompress this region, fastest dimension first; for containers only the overlapping blocks are decoded
 
 metrics:
 -n <option>=<value> the option key to set to value, default none 
@@ -145,10 +168,11 @@ configuration:
 pressio_dtype
 parse_type(std::string const& optarg_s)
 {
-  std::vector<std::string> types{ "float",  "double", "int8",  "int16",
+  static constexpr std::array<std::string_view, 10> types{ "float",  "double", "int8",  "int16",
                                   "int32",  "int64",  "uint8", "uint16",
                                   "uint32", "uint64" };
-  auto index = fuzzy_match(optarg_s, std::begin(types), std::end(types));
+  static constexpr auto types_trie = make_flat_trie<trie_capacity(types)>(types);
+  auto index = fuzzy_match(optarg_s, types_trie);
   if (index) {
     switch (*index) {
       case 0:
@@ -180,7 +204,7 @@ parse_type(std::string const& optarg_s)
     std::cerr << "invalid type: " << optarg_s << std::endl;
     usage();
   }
-  exit(EXIT_FAILURE);
+  tool_exit(EXIT_FAILURE);
 }
 
 std::pair<std::string, std::string>
@@ -203,9 +227,96 @@ parse_option (std::string const& option) {
   return result;
 }
 
+compat::optional<MapHint> parse_load_mode(std::string const& mode) {
+  static constexpr std::array<std::string_view, 5> modes { "read", "mmap", "populate", "willneed", "sequential" };
+  static constexpr auto modes_trie = make_flat_trie<trie_capacity(modes)>(modes);
+  auto id = fuzzy_match(mode, modes_trie);
+  if(id) {
+    switch(*id) {
+      case 0:
+        return compat::nullopt;
+      case 1:
+        return MapHint::None;
+      case 2:
+        return MapHint::Populate;
+      case 3:
+        return MapHint::WillNeed;
+      case 4:
+        return MapHint::Sequential;
+      default:
+        (void)0;
+    }
+  }
+  if(cmdline_rank == 0) {
+    std::cerr << "invalid load mode: " << mode << std::endl;
+    usage();
+  }
+  tool_exit(EXIT_FAILURE);
+}
+
+OutputMode parse_output_mode(std::string const& mode) {
+  static constexpr std::array<std::string_view, 2> modes { "write", "mmap" };
+  static constexpr auto modes_trie = make_flat_trie<trie_capacity(modes)>(modes);
+  auto id = fuzzy_match(mode, modes_trie);
+  if(id) {
+    switch(*id) {
+      case 0:
+        return OutputMode::Write;
+      case 1:
+        return OutputMode::Mmap;
+      default:
+        (void)0;
+    }
+  }
+  if(cmdline_rank == 0) {
+    std::cerr << "invalid output mode: " << mode << std::endl;
+    usage();
+  }
+  tool_exit(EXIT_FAILURE);
+}
+
+void parse_bench(std::string const& spec, cmdline_options& opts) {
+  try {
+    auto colon = spec.find(':');
+    if(colon == std::string::npos) {
+      opts.bench_iterations = std::stoull(spec);
+    } else {
+      opts.bench_warmup = std::stoull(spec.substr(0, colon));
+      opts.bench_iterations = std::stoull(spec.substr(colon + 1));
+    }
+  } catch(std::exception const&) {
+    if(cmdline_rank == 0) {
+      std::cerr << "invalid bench iterations: " << spec << std::endl;
+      usage();
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+}
+
+void reset_getopt() {
+#ifdef __GLIBC__
+  optind = 0;
+#else
+  optind = 1;
+  optreset = 1;
+#endif
+}
+
+std::vector<hyperslab_range> parse_region(const char* region) {
+  try {
+    return parse_hyperslab(region);
+  } catch(std::exception const& ex) {
+    if(cmdline_rank == 0) {
+      std::cerr << "invalid region " << region << ": " << ex.what() << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+}
+
 Action parse_action(std::string const& action) {
-  std::vector<std::string> actions { "compress", "decompress", "versions", "settings", "help", "fullhelp", "graph", "save", "load"};
-  auto id = fuzzy_match(action, std::begin(actions), std::end(actions));
+  static constexpr std::array<std::string_view, 14> actions { "compress", "decompress", "versions", "settings", "help", "fullhelp", "graph", "save", "load", "stream-compress", "bench", "serve", "profile-graph", "watch"};
+  static constexpr auto actions_trie = make_flat_trie<trie_capacity(actions)>(actions);
+  auto id = fuzzy_match(action, actions_trie);
   if(id) {
     switch(*id)
     {
@@ -227,6 +338,16 @@ Action parse_action(std::string const& action) {
         return Action::SaveConfig;
       case 8:
         return Action::LoadConfig;
+      case 9:
+        return Action::StreamCompress;
+      case 10:
+        return Action::Bench;
+      case 11:
+        return Action::Serve;
+      case 12:
+        return Action::ProfileGraph;
+      case 13:
+        return Action::Watch;
       default:
         (void)0;
     }
@@ -234,10 +355,64 @@ Action parse_action(std::string const& action) {
 
   std::cerr << "invalid action: " << action << std::endl;
   usage();
-  exit(EXIT_FAILURE);
+  tool_exit(EXIT_FAILURE);
+
+}
 
+/**
+ * the extension of the file name in path including its dot, or empty if it has none
+ */
+std::string path_extension(std::string const& path) {
+  const std::string name = path.substr(path.rfind('/') + 1);
+  const size_t dot = name.rfind('.');
+  return (dot == std::string::npos) ? std::string() : name.substr(dot);
 }
 
+/**
+ * io plugins configured once per format, path extension, and set of options;
+ * every input group with the same settings gets a clone that only differs in
+ * its path.
+ *
+ * some formats such as by_extension only have their options once the path is
+ * known, so prototypes are configured with the path of the first group that
+ * uses them
+ */
+class io_prototypes {
+  public:
+  pressio_io make(std::string const& format, std::multimap<std::string, std::string> const& early_io_options,
+      std::multimap<std::string, std::string> const& io_options, compat::optional<std::string> const& path) {
+    std::ostringstream key;
+    key << format << '\0';
+    if(path) key << '.' << path_extension(*path);
+    key << '\0';
+    for (auto const& option : early_io_options) key << option.first << '=' << option.second << '\0';
+    key << '\0';
+    for (auto const& option : io_options) key << option.first << '=' << option.second << '\0';
+    auto it = prototypes.find(key.str());
+    if(it == prototypes.end()) {
+      pressio_io io = library.get_io(format);
+      if(!io) {
+        std::cerr << "failed to get io module " << format << std::endl;
+        tool_exit(EXIT_FAILURE);
+      }
+      compat::optional<pressio_options> null;
+      io->set_options(options_from_multimap(early_io_options));
+      if(path) {
+        io->set_options({
+            {"io:path", *path}
+        });
+      }
+      set_options_from_multimap(*io, io_options, "io", null);
+      it = prototypes.emplace(key.str(), std::move(io)).first;
+    }
+    return pressio_io(it->second->clone());
+  }
+
+  private:
+  pressio library;
+  std::map<std::string, pressio_io> prototypes;
+};
+
 class io_builder {
   public:
   void set_format(std::string const& format) {
@@ -260,6 +435,22 @@ class io_builder {
   void push_dim(size_t dim) {
     dims.push_back(dim);
   }
+  void set_dims(std::vector<size_t> const& new_dims) {
+    dims = new_dims;
+  }
+  void set_path(std::string const& path) {
+    io_options.erase("io:path");
+    io_options.emplace("io:path", path);
+  }
+  void set_selection(std::vector<hyperslab_range> const& ranges) {
+    selection = ranges;
+  }
+  void set_mapped(compat::optional<MapHint> const& hint) {
+    mapped = hint;
+  }
+  void set_output_mode(OutputMode mode) {
+    output_mode = mode;
+  }
   template <class... T>
   void emplace_option(T&&... setting) {
     io_options.emplace(std::forward<T>(setting)...);
@@ -270,30 +461,43 @@ class io_builder {
     early_io_options.emplace(std::forward<T>(setting)...);
   }
 
-  pressio_io make_io() const {
-    auto library = pressio();
+  pressio_io make_io(io_prototypes& prototypes) const {
     auto io_format_str = io_format.value_or("noop");
-    pressio_io io = library.get_io(io_format_str);
-    if(!io) {
-      std::cerr << "failed to get io module " << io_format_str << std::endl;
-      exit(EXIT_FAILURE);
+    if(io_format_str == "container") {
+      //containers are assembled by pressio and then written as plain bytes
+      io_format_str = "posix";
     }
-    if(io_options.find("io:path") != io_options.end()) {
-      if(io_options.count("io:path") == 1) {
-        std::string io_path = io_options.find("io:path")->second;
-        io->set_options({
-            {"io:path", io_path}
-        });
-      } else {
-        std::cerr << "multiple io_paths not supported";
-        exit(EXIT_FAILURE);
-      }
+    if(io_options.count("io:path") > 1) {
+      std::cerr << "multiple io_paths not supported";
+      tool_exit(EXIT_FAILURE);
+    }
+    auto options = io_options;
+    options.erase("io:path");
+    compat::optional<std::string> io_path;
+    if(io_options.count("io:path") == 1) {
+      io_path = io_options.find("io:path")->second;
+    }
+    pressio_io io = prototypes.make(io_format_str, early_io_options, options, io_path);
+    if(io_path) {
+      io->set_options({
+          {"io:path", *io_path}
+      });
     }
-    compat::optional<pressio_options> null;
-    io->set_options(options_from_multimap(early_io_options));
-    set_options_from_multimap(*io, io_options, "io", null);
     return io;
   }
+  io_description describe() const {
+    io_description desc;
+    desc.format = io_format;
+    desc.dtype = type;
+    desc.dims = dims;
+    desc.selection = selection;
+    desc.mapped = mapped;
+    desc.output_mode = output_mode;
+    if(io_options.count("io:path") == 1) {
+      desc.path = io_options.find("io:path")->second;
+    }
+    return desc;
+  }
   std::unique_ptr<pressio_data> make_input_desc() const {
     return (type)
       ? std::make_unique<pressio_data>(pressio_data::owning(*type, dims.size(), dims.data()))
@@ -303,18 +507,81 @@ class io_builder {
   private:
   compat::optional<pressio_dtype> type;
   std::vector<size_t> dims;
+  std::vector<hyperslab_range> selection;
+  compat::optional<MapHint> mapped;
+  OutputMode output_mode = OutputMode::Write;
   compat::optional<std::string> io_format;
   std::multimap<std::string, std::string> io_options;
   std::multimap<std::string, std::string> early_io_options;
 };
 
+void set_input_path(io_builder& builder, std::string const& path) {
+#if LIBPRESSIO_MAJOR_VERSION > 0 || (LIBPRESSIO_MAJOR_VERSION == 0 && LIBPRESSIO_MINOR_VERSION >= 89)
+  builder.set_format_if("by_extension");
+#else
+  builder.set_format_if("posix");
+#endif
+  builder.set_path(path);
+}
+
+/**
+ * replaces the last input group with one group per manifest entry, using the
+ * command line settings of that group as defaults
+ */
+void expand_input_list(std::string const& path, std::vector<io_builder>& input_builder,
+    std::vector<io_builder>& compressed_builder, std::vector<io_builder>& decompressed_builder) {
+  std::vector<input_list_entry> entries;
+  try {
+    entries = load_input_list(path);
+  } catch(std::exception const& ex) {
+    if(cmdline_rank == 0) {
+      std::cerr << "failed to read input manifest " << ex.what() << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+  const io_builder input_defaults = input_builder.back();
+  const io_builder compressed_defaults = compressed_builder.back();
+  const io_builder decompressed_defaults = decompressed_builder.back();
+  input_builder.pop_back();
+  compressed_builder.pop_back();
+  decompressed_builder.pop_back();
+  input_builder.reserve(input_builder.size() + entries.size());
+  compressed_builder.reserve(compressed_builder.size() + entries.size());
+  decompressed_builder.reserve(decompressed_builder.size() + entries.size());
+  for (auto const& entry : entries) {
+    io_builder& input = input_builder.emplace_back(input_defaults);
+    if(entry.format) input.set_format(*entry.format);
+    set_input_path(input, entry.input);
+    if(entry.dtype) input.set_type(parse_type(*entry.dtype));
+    if(!entry.dims.empty()) input.set_dims(entry.dims);
+
+    io_builder& compressed = compressed_builder.emplace_back(compressed_defaults);
+    if(entry.compressed_format) compressed.set_format(*entry.compressed_format);
+    if(entry.compressed) {
+      compressed.set_format_if("posix");
+      compressed.set_path(*entry.compressed);
+    }
+
+    io_builder& decompressed = decompressed_builder.emplace_back(decompressed_defaults);
+    if(entry.decompressed_format) decompressed.set_format(*entry.decompressed_format);
+    if(entry.decompressed) {
+      decompressed.set_format_if("posix");
+      decompressed.set_path(*entry.decompressed);
+    }
+  }
+}
+
 }
 
 cmdline_options
 parse_args(int argc, char* argv[])
 {
+  //pressio serve parses a command line for every request
+  reset_getopt();
+  int cmdline_size = 1;
 #if LIBPRESSIO_TOOLS_HAS_MPI
   MPI_Comm_rank(MPI_COMM_WORLD, &cmdline_rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &cmdline_size);
 #endif
   int opt;
   cmdline_options opts;
@@ -331,10 +598,10 @@ parse_args(int argc, char* argv[])
 
   if(argc == 1) {
     usage();
-    exit(0);
+    tool_exit(0);
   }
 
-  while ((opt = getopt(argc, argv, "a:b:d:D:e:E:g:G:t:i:jl:I:u:U:T:f:w:s:y:z:F:W:S:Y:Z:m:M:n:N:o:pO:C:Qr:")) != -1) {
+  while ((opt = getopt(argc, argv, "a:A:b:B:c:d:D:e:E:g:G:Ht:i:jJ:K:l:L:I:u:U:T:f:vVw:s:x:X:y:z:F:W:S:Y:Z:m:M:n:N:o:PpO:C:Qq:r:R:")) != -1) {
     switch (opt) {
       case 'a':
         actions.emplace(parse_action(optarg));
@@ -342,6 +609,15 @@ parse_args(int argc, char* argv[])
       case 'b':
         opts.early_options.emplace(parse_option(optarg));
         break;
+      case 'A':
+        opts.serve_address = optarg;
+        break;
+      case 'B':
+        parse_bench(optarg, opts);
+        break;
+      case 'c':
+        opts.chunk_size = std::stoull(optarg);
+        break;
       case 'C':
         opts.print_compile_options.emplace(optarg);
         break;
@@ -349,10 +625,23 @@ parse_args(int argc, char* argv[])
         input_builder.back().push_dim(std::stoull(optarg));
         break;
       case 'D':
-        opts.extra_dl_handles.push_back(dlopen(optarg, RTLD_LAZY | RTLD_GLOBAL));
-        if(opts.extra_dl_handles.back() == nullptr) {
-          std::cerr << "failed loading: " << optarg << ": " << dlerror() << std::endl;
-          exit(1);
+        {
+          //pressio serve parses -D for every request, but each library only needs opening once
+          static std::map<std::string, void*> opened_libraries;
+          auto opened = opened_libraries.find(optarg);
+          if(opened == opened_libraries.end()) {
+            void* handle;
+            {
+              phase_timer timer(opts.startup_phases, std::string("dlopen ") + optarg);
+              handle = dlopen(optarg, RTLD_LAZY | RTLD_GLOBAL);
+            }
+            if(handle == nullptr) {
+              std::cerr << "failed loading: " << optarg << ": " << dlerror() << std::endl;
+              tool_exit(1);
+            }
+            opened = opened_libraries.emplace(optarg, handle).first;
+          }
+          opts.extra_dl_handles.push_back(opened->second);
         }
         break;
       case 'e':
@@ -376,9 +665,21 @@ parse_args(int argc, char* argv[])
       case 'j':
         opts.format = OutputFormat::JSON;
         break;
+      case 'H':
+        opts.low_memory = true;
+        break;
+      case 'q':
+        opts.pipeline_depth = std::max<size_t>(1, std::stoull(optarg));
+        break;
+      case 'J':
+        opts.threads = std::max<size_t>(1, std::stoull(optarg));
+        break;
       case 'l':
         opts.config_file = optarg;
         break;
+      case 'L':
+        input_builder.back().set_mapped(parse_load_mode(optarg));
+        break;
       case 'i':
 #if LIBPRESSIO_MAJOR_VERSION > 0 || (LIBPRESSIO_MAJOR_VERSION == 0 && LIBPRESSIO_MINOR_VERSION >= 89)
         input_builder.back().set_format_if("by_extension");
@@ -398,6 +699,9 @@ parse_args(int argc, char* argv[])
       case 'k':
         opts.num_compressed = std::stoull(optarg);
         break;
+      case 'K':
+        opts.input_list = optarg;
+        break;
       case 'm':
         opts.metrics_ids.push_back(optarg);
         break;
@@ -416,11 +720,27 @@ parse_args(int argc, char* argv[])
       case 'O':
         opts.print_options.emplace(optarg);
         break;
+      case 'P':
+#if LIBPRESSIO_TOOLS_HAS_MPI
+        opts.partitioned = true;
+#else
+        if(cmdline_rank == 0) {
+          std::cerr << "-P requires libpressio_tools to be built with MPI" << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+#endif
+        break;
       case 'p':
         input_builder.emplace_back();
         compressed_builder.emplace_back();
         decompressed_builder.emplace_back();
         break;
+      case 'v':
+        opts.startup_timing = true;
+        break;
+      case 'V':
+        opts.graph_verbose = true;
+        break;
       case 'w':
         compressed_builder.back().set_format_if("posix");
         compressed_builder.back().emplace_option("io:path", optarg);
@@ -435,6 +755,9 @@ parse_args(int argc, char* argv[])
       case 'r':
         domain_manager().set_options({{"domain:metrics", std::string(optarg)}});
         break;
+      case 'R':
+        opts.region = parse_region(optarg);
+        break;
       case 's':
         compressed_builder.back().set_format_if("hdf5", [](std::string const& s) {return s == "posix";});
         compressed_builder.back().emplace_option("hdf5:dataset", optarg);
@@ -455,6 +778,12 @@ parse_args(int argc, char* argv[])
       case 'U':
         opts.print_io_input_options.emplace(optarg);
         break;
+      case 'x':
+        input_builder.back().set_selection(parse_region(optarg));
+        break;
+      case 'X':
+        decompressed_builder.back().set_output_mode(parse_output_mode(optarg));
+        break;
       case 'y':
         compressed_builder.back().emplace_option(parse_option(optarg));
         break;
@@ -469,28 +798,163 @@ parse_args(int argc, char* argv[])
         break;
       default:
         usage();
-        exit(EXIT_FAILURE);
+        tool_exit(EXIT_FAILURE);
     }
   }
   if (actions.empty()) opts.actions = {Action::Compress, Action::Decompress, Action::Settings};
   else opts.actions = std::move(actions);
 
-  if(contains_one_of(opts.actions, {Action::Compress, Action::Settings, Action::Decompress, Action::Help, Action::FullHelp, Action::SaveConfig, Action::LoadConfig})) {
+  bool compressor_from_args = false;
+  if(contains_one_of(opts.actions, {Action::Compress, Action::Settings, Action::Decompress, Action::Help, Action::FullHelp, Action::SaveConfig, Action::LoadConfig, Action::StreamCompress, Action::Bench, Action::ProfileGraph, Action::Watch})) {
     if(optind < argc) {
       opts.compressor = argv[optind++];
+      compressor_from_args = true;
+    }
+  }
+
+
+  if(opts.input_list) {
+    if(opts.partitioned) {
+      if(cmdline_rank == 0) {
+        std::cerr << "-K cannot be combined with -P" << std::endl;
+      }
+      tool_exit(EXIT_FAILURE);
     }
+    expand_input_list(*opts.input_list, input_builder, compressed_builder, decompressed_builder);
+    //inputs from a manifest are read one at a time right before they are compressed
+    if(!opts.pipeline_depth) opts.low_memory = true;
   }
 
+  if(processes_per_input(opts) && opts.partitioned) {
+    if(cmdline_rank == 0) {
+      std::cerr << "-q and -H cannot be combined with -P" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
 
+  //stream-compress reads its inputs a chunk at a time, -q/-H read them one at a time, and watch reads files as they appear, so skip reading them up front
+  const bool uses_inputs = contains_one_of(opts.actions, {Action::Compress, Action::Decompress, Action::Bench, Action::ProfileGraph});
+  const bool times_inputs = contains_one_of(opts.actions, {Action::Bench, Action::ProfileGraph});
+  const bool read_inputs = (!contains_one_of(opts.actions, {Action::StreamCompress, Action::Watch}) || uses_inputs) &&
+    (!processes_per_input(opts) || times_inputs);
+  io_prototypes prototypes;
+  opts.input_file_action.reserve(input_builder.size());
+  opts.input_descriptions.reserve(input_builder.size());
+  bool compressor_peeked = false;
   for (auto const& input_buffer : input_builder) {
-    opts.input_file_action.emplace_back(input_buffer.make_io());
+    opts.input_file_action.emplace_back(input_buffer.make_io(prototypes));
+    opts.input_descriptions.emplace_back(input_buffer.describe());
+    if(opts.input_descriptions.back().path && is_shared_memory_path(*opts.input_descriptions.back().path) &&
+        !opts.input_descriptions.back().mapped) {
+      //shared memory segments are always attached in place
+      opts.input_descriptions.back().mapped = MapHint::None;
+    }
+    auto const& input_desc = opts.input_descriptions.back();
+    if(!read_inputs && !compressor_from_args && !compressor_peeked && contains(opts.actions, Action::Decompress) &&
+        !contains(opts.actions, Action::Compress) && input_desc.path && is_container_file(*input_desc.path)) {
+      //the container is read later, but the compressor has to be known now
+      try {
+        container_view container(map_input_file(*input_desc.path, compat::nullopt, {}, MapHint::None));
+        if(!container.header().compressor_id.empty()) {
+          opts.compressor = container.header().compressor_id;
+          compressor_peeked = true;
+        }
+      } catch(std::exception const& ex) {
+        if(cmdline_rank == 0) {
+          std::cerr << "failed to read container " << *input_desc.path << ": " << ex.what() << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+    }
+    if(!read_inputs) continue;
+    if(contains(opts.actions, Action::Decompress) && !contains(opts.actions, Action::Compress) &&
+        input_desc.path && is_container_file(*input_desc.path)) {
+      //containers describe their own type and dimensions, so read them as-is
+      try {
+        //with -P each rank only touches the pages of the blocks it decodes
+        opts.input.emplace_back((input_desc.mapped || opts.partitioned)
+            ? map_input_file(*input_desc.path, compat::nullopt, {}, input_desc.mapped.value_or(MapHint::None))
+            : load_container_file(*input_desc.path));
+        container_view container(opts.input.back());
+        if(!compressor_from_args && !container.header().compressor_id.empty()) {
+          opts.compressor = container.header().compressor_id;
+        }
+      } catch(std::exception const& ex) {
+        if(cmdline_rank == 0) {
+          std::cerr << "failed to read container " << *input_desc.path << ": " << ex.what() << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+      continue;
+    }
+    if(opts.partitioned) {
+      if(!contains_one_of(opts.actions, {Action::Compress, Action::Decompress})) continue;
+      if(!contains(opts.actions, Action::Compress)) {
+        if(cmdline_rank == 0) {
+          std::cerr << "-P decompression requires container inputs" << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+      //each rank only reads its slab of the selected input
+      try {
+        auto reader = make_hyperslab_reader(opts.input_file_action.back(), input_desc);
+        const hyperslab global = resolve_selection(input_desc);
+        if(global.count.empty()) {
+          throw std::runtime_error("-P requires the dimensions of each input (-d)");
+        }
+        const hyperslab local = partition_hyperslab(global, cmdline_rank, cmdline_size);
+        opts.partitions.emplace_back(global);
+        opts.input.emplace_back((local.count.back() == 0)
+            ? pressio_data::empty(input_desc.dtype.value_or(pressio_byte_dtype), local.count)
+            : reader->read(local));
+      } catch(std::exception const& ex) {
+        if(cmdline_rank == 0) {
+          std::cerr << "failed to read the partition of the input: " << ex.what() << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+      continue;
+    }
+    if(input_desc.mapped) {
+      if(!uses_inputs) continue;
+      if(!input_desc.path || !input_desc.selection.empty() ||
+          !is_raw_input(input_desc)) {
+        if(cmdline_rank == 0) {
+          std::cerr << "-L mmap requires a raw binary input from -i without -x" << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+      try {
+        opts.input.emplace_back(map_input_file(*input_desc.path, input_desc.dtype, input_desc.dims, *input_desc.mapped));
+      } catch(std::exception const& ex) {
+        if(cmdline_rank == 0) {
+          std::cerr << "failed to map input file: " << ex.what() << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+      continue;
+    }
+    if(!input_desc.selection.empty()) {
+      if(!uses_inputs) continue;
+      //only read the selected region from disk
+      try {
+        auto reader = make_hyperslab_reader(opts.input_file_action.back(), input_desc);
+        opts.input.emplace_back(reader->read(resolve_selection(input_desc)));
+      } catch(std::exception const& ex) {
+        if(cmdline_rank == 0) {
+          std::cerr << "failed to read the selected region of the input: " << ex.what() << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+      continue;
+    }
     pressio_data* read_data = opts.input_file_action.back()->read(input_buffer.make_input_desc().get());
-    if(contains_one_of(opts.actions, {Action::Compress, Action::Decompress})) {
+    if(uses_inputs) {
       if(read_data == nullptr) {
         if(cmdline_rank == 0) {
           std::cerr << "failed to read input file " << pressio_io_error_msg(&opts.input_file_action.back()) << std::endl;
         }
-        exit(EXIT_FAILURE);
+        tool_exit(EXIT_FAILURE);
       } else {
         opts.input.emplace_back(std::move(*read_data));
         delete read_data;
@@ -499,11 +963,34 @@ parse_args(int argc, char* argv[])
   }
 
 
+  opts.compressed_file_action.reserve(compressed_builder.size());
+  opts.decompressed_file_action.reserve(decompressed_builder.size());
   for(size_t i = 0; i < compressed_builder.size(); ++i) {
-    opts.compressed_file_action.emplace_back(compressed_builder[i].make_io());
+    opts.compressed_file_action.emplace_back(compressed_builder[i].make_io(prototypes));
+    opts.compressed_descriptions.emplace_back(compressed_builder[i].describe());
   }
   for (size_t i = 0; i < decompressed_builder.size(); ++i) {
-    opts.decompressed_file_action.emplace_back(decompressed_builder[i].make_io());
+    opts.decompressed_file_action.emplace_back(decompressed_builder[i].make_io(prototypes));
+    opts.decompressed_descriptions.emplace_back(decompressed_builder[i].describe());
+    auto const& desc = opts.decompressed_descriptions.back();
+    if(desc.output_mode == OutputMode::Mmap && desc.format && *desc.format != "posix") {
+      //the mapping is written as raw bytes, which would not be a valid file of any other format
+      if(cmdline_rank == 0) {
+        std::cerr << "-X mmap requires a raw binary decompressed file, not " << *desc.format << std::endl;
+      }
+      tool_exit(EXIT_FAILURE);
+    }
+  }
+  //-P and stream-compress write their outputs piece by piece through files, which shm: names are not
+  auto is_shared_memory_output = [](io_description const& desc) { return desc.path && is_shared_memory_path(*desc.path); };
+  const bool shm_compressed = std::any_of(opts.compressed_descriptions.begin(), opts.compressed_descriptions.end(), is_shared_memory_output);
+  const bool shm_decompressed = std::any_of(opts.decompressed_descriptions.begin(), opts.decompressed_descriptions.end(), is_shared_memory_output);
+  const bool partitioned_to_shm = opts.partitioned && (shm_compressed || shm_decompressed);
+  if(partitioned_to_shm || (contains(opts.actions, Action::StreamCompress) && shm_compressed)) {
+    if(cmdline_rank == 0) {
+      std::cerr << (partitioned_to_shm ? "-P" : "stream-compress") << " does not support shared memory (shm:) outputs" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
   }
   return opts;
 }
@@ -2,6 +2,7 @@
 #define PRESSIO_TOOLS_CMDLINE
 #include <set>
 #include <map>
+#include <string>
 #include <vector>
 #include <std_compat/optional.h>
 #include <memory>
@@ -12,11 +13,23 @@
 #include <libpressio_ext/io/pressio_io.h>
 #include <libpressio_ext/cpp/data.h>
 #include <libpressio_ext/cpp/io.h>
+#include <utils/hyperslab.h>
+#include "startup.h"
 
 enum class OutputFormat {
   Human,
   JSON
 };
+enum class MapHint {
+  None,
+  Populate,
+  WillNeed,
+  Sequential
+};
+enum class OutputMode {
+  Write,
+  Mmap
+};
 enum class Action
 {
   Version,
@@ -27,7 +40,12 @@ enum class Action
   Settings,
   Help,
   FullHelp,
-  Graph
+  Graph,
+  StreamCompress,
+  Bench,
+  Serve,
+  ProfileGraph,
+  Watch
 };
 
 template <class Set, class Item>
@@ -44,6 +62,17 @@ bool contains_one_of(Set const& set, std::initializer_list<Action> items) {
 }
 
 
+struct io_description
+{
+  compat::optional<std::string> format;
+  compat::optional<std::string> path;
+  compat::optional<pressio_dtype> dtype;
+  std::vector<size_t> dims;
+  std::vector<hyperslab_range> selection;
+  compat::optional<MapHint> mapped;
+  OutputMode output_mode = OutputMode::Write;
+};
+
 struct cmdline_options
 {
   std::set<Action> actions;
@@ -64,13 +93,37 @@ struct cmdline_options
   std::vector<pressio_io> input_file_action;
   std::vector<pressio_io> compressed_file_action;
   std::vector<pressio_io> decompressed_file_action;
+  std::vector<io_description> input_descriptions;
+  std::vector<io_description> compressed_descriptions;
+  std::vector<io_description> decompressed_descriptions;
   compat::optional<std::string> qualified_prefix;
   compat::optional<size_t> num_compressed;
+  compat::optional<size_t> chunk_size;
+  compat::optional<std::vector<hyperslab_range>> region;
+  bool partitioned = false;
+  std::vector<hyperslab> partitions;
+  size_t threads = 1;
+  compat::optional<size_t> pipeline_depth;
+  bool low_memory = false;
+  compat::optional<std::string> serve_address;
+  compat::optional<std::string> input_list;
+  bool startup_timing = false;
+  std::vector<startup_phase> startup_phases;
+  size_t bench_warmup = 1;
+  size_t bench_iterations = 10;
   OutputFormat format = OutputFormat::Human;
   std::vector<void*> extra_dl_handles;
   std::string graph_format = "graphviz";
+  bool graph_verbose = false;
 };
 
+/**
+ * true if inputs are read and processed one at a time rather than up front
+ */
+inline bool processes_per_input(cmdline_options const& opts) {
+  return opts.pipeline_depth || opts.low_memory;
+}
+
 cmdline_options parse_args(int argc, char* argv[]);
 
 #endif /*PRESSIO_TOOLS_CMDLINE*/
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "container.h"
+#include "mapped.h"
+
+namespace {
+const char container_magic[8] = {'P','R','E','S','S','I','O','C'};
+const uint32_t container_version = 1;
+const size_t container_trailer_size = sizeof(uint64_t) + sizeof(container_magic);
+
+template <class T>
+uint64_t write_pod(std::ostream& out, T const& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  return sizeof(T);
+}
+
+uint64_t write_string(std::ostream& out, std::string const& value) {
+  uint64_t written = write_pod(out, static_cast<uint64_t>(value.size()));
+  out.write(value.data(), value.size());
+  return written + value.size();
+}
+
+class byte_cursor {
+  public:
+  byte_cursor(const char* begin, size_t size): pos(begin), end(begin + size) {}
+
+  template <class T>
+  T read() {
+    T value;
+    require(sizeof(T));
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+  std::string read_string() {
+    auto size = read<uint64_t>();
+    require(size);
+    std::string value(pos, size);
+    pos += size;
+    return value;
+  }
+  void require(size_t n) const {
+    if(static_cast<size_t>(end - pos) < n) {
+      throw std::runtime_error("truncated container");
+    }
+  }
+
+  private:
+  const char* pos;
+  const char* end;
+};
+}
+
+container_writer::container_writer(std::ostream& out, container_header const& header):
+  out(out)
+{
+  const std::string bytes = container_header_bytes(header);
+  out.write(bytes.data(), bytes.size());
+  offset += bytes.size();
+}
+
+void container_writer::append(pressio_data const& block) {
+  const uint64_t size = block.size_in_bytes();
+  out.write(static_cast<const char*>(block.data()), size);
+  if(!out) {
+    throw std::runtime_error("failed to write compressed block");
+  }
+  index.push_back({offset, size});
+  offset += size;
+}
+
+void container_writer::finish() {
+  const std::string bytes = container_index_bytes(index, offset);
+  out.write(bytes.data(), bytes.size());
+  out.flush();
+  if(!out) {
+    throw std::runtime_error("failed to write the container index");
+  }
+}
+
+std::string container_header_bytes(container_header const& header) {
+  std::ostringstream out;
+  out.write(container_magic, sizeof(container_magic));
+  write_pod(out, container_version);
+  write_pod(out, static_cast<uint32_t>(header.dtype));
+  write_pod(out, static_cast<uint64_t>(header.dims.size()));
+  for (auto dim : header.dims) {
+    write_pod(out, static_cast<uint64_t>(dim));
+  }
+  write_pod(out, header.block_extent);
+  write_string(out, header.compressor_id);
+  write_string(out, header.compressor_options);
+  return out.str();
+}
+
+std::string container_index_bytes(std::vector<container_block> const& index, uint64_t index_offset) {
+  std::ostringstream out;
+  write_pod(out, static_cast<uint64_t>(index.size()));
+  for (auto const& block : index) {
+    write_pod(out, block.offset);
+    write_pod(out, block.size);
+  }
+  write_pod(out, index_offset);
+  out.write(container_magic, sizeof(container_magic));
+  return out.str();
+}
+
+container_view::container_view(pressio_data const& data):
+  base(static_cast<const char*>(data.data()))
+{
+  const size_t size = data.size_in_bytes();
+  if(!is_container(data) || size < sizeof(container_magic) + container_trailer_size) {
+    throw std::runtime_error("not a pressio container");
+  }
+  byte_cursor header_cursor(base + sizeof(container_magic), size - sizeof(container_magic));
+  auto version = header_cursor.read<uint32_t>();
+  if(version != container_version) {
+    throw std::runtime_error("unsupported container version " + std::to_string(version));
+  }
+  hdr.dtype = static_cast<pressio_dtype>(header_cursor.read<uint32_t>());
+  hdr.dims.resize(header_cursor.read<uint64_t>());
+  for (auto& dim : hdr.dims) {
+    dim = header_cursor.read<uint64_t>();
+  }
+  hdr.block_extent = header_cursor.read<uint64_t>();
+  if(hdr.dims.empty() || hdr.block_extent == 0) {
+    throw std::runtime_error("corrupt container");
+  }
+  hdr.compressor_id = header_cursor.read_string();
+  hdr.compressor_options = header_cursor.read_string();
+
+  //a complete container ends with the magic again, anything else was cut short
+  if(std::memcmp(base + size - sizeof(container_magic), container_magic, sizeof(container_magic)) != 0) {
+    throw std::runtime_error("truncated container");
+  }
+  uint64_t index_offset;
+  std::memcpy(&index_offset, base + size - container_trailer_size, sizeof(index_offset));
+  if(index_offset > size - container_trailer_size) {
+    throw std::runtime_error("corrupt container index offset");
+  }
+  byte_cursor index_cursor(base + index_offset, size - container_trailer_size - index_offset);
+  index.resize(index_cursor.read<uint64_t>());
+  for (auto& block : index) {
+    block.offset = index_cursor.read<uint64_t>();
+    block.size = index_cursor.read<uint64_t>();
+    if(block.offset > index_offset || block.size > index_offset - block.offset) {
+      throw std::runtime_error("corrupt container block index");
+    }
+  }
+  //every block but the last holds block_extent entries of the slowest dimension; an empty input is stored as at most one block
+  const size_t slowest = hdr.dims.back();
+  const size_t expected_blocks = slowest / hdr.block_extent + (slowest % hdr.block_extent != 0);
+  if(index.size() != expected_blocks && !(expected_blocks == 0 && index.size() == 1)) {
+    throw std::runtime_error("corrupt container");
+  }
+}
+
+pressio_data container_view::block(size_t i) const {
+  auto const& entry = index.at(i);
+  return pressio_data::nonowning(pressio_byte_dtype, const_cast<char*>(base + entry.offset), {entry.size});
+}
+
+size_t container_view::block_start(size_t i) const {
+  return i * hdr.block_extent;
+}
+
+size_t container_view::block_count(size_t i) const {
+  const size_t slowest = hdr.dims.back();
+  const size_t start = block_start(i);
+  return (start >= slowest) ? 0 : std::min<size_t>(hdr.block_extent, slowest - start);
+}
+
+pressio_data pack_container(container_header const& header, std::vector<pressio_data> const& blocks) {
+  std::ostringstream out;
+  container_writer writer(out, header);
+  for (auto const& block : blocks) {
+    writer.append(block);
+  }
+  writer.finish();
+  std::string const& bytes = out.str();
+  return pressio_data::copy(pressio_byte_dtype, bytes.data(), {bytes.size()});
+}
+
+bool is_container(pressio_data const& data) {
+  return data.data() != nullptr && data.size_in_bytes() >= sizeof(container_magic) &&
+    std::memcmp(data.data(), container_magic, sizeof(container_magic)) == 0;
+}
+
+bool is_container_file(std::string const& path) {
+  if(is_shared_memory_path(path)) {
+    try {
+      pressio_data segment = map_input_file(path, compat::nullopt, {}, MapHint::None);
+      return segment.size_in_bytes() >= sizeof(container_magic) &&
+        std::memcmp(segment.data(), container_magic, sizeof(container_magic)) == 0;
+    } catch(std::exception const&) {
+      return false;
+    }
+  }
+  char magic[sizeof(container_magic)];
+  std::ifstream in(path, std::ios::binary);
+  return in.read(magic, sizeof(magic)) && std::memcmp(magic, container_magic, sizeof(magic)) == 0;
+}
+
+pressio_data load_container_file(std::string const& path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if(!in) {
+    throw std::runtime_error("failed to open " + path);
+  }
+  const size_t size = in.tellg();
+  pressio_data data = pressio_data::owning(pressio_byte_dtype, {size});
+  in.seekg(0);
+  if(!in.read(static_cast<char*>(data.data()), size)) {
+    throw std::runtime_error("failed to read " + path);
+  }
+  return data;
+}
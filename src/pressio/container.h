@@ -0,0 +1,98 @@
+#ifndef CONTAINER_H_Q3NVW8TX
+#define CONTAINER_H_Q3NVW8TX
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <pressio_dtype.h>
+#include <libpressio_ext/cpp/data.h>
+
+/**
+ * a self-describing chunked container for compressed data
+ *
+ * the file consists of a header, the compressed blocks back to back, and an
+ * index of the blocks followed by a fixed size trailer that locates the index.
+ * Each block holds block_extent entries along the slowest (last) dimension
+ * except possibly the last one.  Integers are stored in native byte order.
+ */
+struct container_header {
+  pressio_dtype dtype = pressio_byte_dtype;
+  std::vector<size_t> dims;
+  uint64_t block_extent = 0;
+  std::string compressor_id;
+  std::string compressor_options;
+};
+
+struct container_block {
+  uint64_t offset;
+  uint64_t size;
+};
+
+/**
+ * writes a container to out one compressed block at a time
+ */
+class container_writer {
+  public:
+  container_writer(std::ostream& out, container_header const& header);
+  void append(pressio_data const& block);
+  void finish();
+
+  private:
+  std::ostream& out;
+  std::vector<container_block> index;
+  uint64_t offset = 0;
+};
+
+/**
+ * a non-owning view of a container held in memory
+ */
+class container_view {
+  public:
+  explicit container_view(pressio_data const& data);
+  container_header const& header() const { return hdr; }
+  size_t num_blocks() const { return index.size(); }
+  /** the compressed bytes of block i; valid as long as the viewed data */
+  pressio_data block(size_t i) const;
+  /** the first entry along the slowest dimension stored in block i */
+  size_t block_start(size_t i) const;
+  /** the number of entries along the slowest dimension stored in block i */
+  size_t block_count(size_t i) const;
+
+  private:
+  const char* base;
+  container_header hdr;
+  std::vector<container_block> index;
+};
+
+/**
+ * the serialized header of a container; blocks start right after it
+ */
+std::string container_header_bytes(container_header const& header);
+
+/**
+ * the serialized index and trailer of a container whose index starts at
+ * index_offset
+ */
+std::string container_index_bytes(std::vector<container_block> const& index, uint64_t index_offset);
+
+/**
+ * serializes a complete container into memory
+ */
+pressio_data pack_container(container_header const& header, std::vector<pressio_data> const& blocks);
+
+/**
+ * true if data starts with the container magic
+ */
+bool is_container(pressio_data const& data);
+
+/**
+ * true if the file at path starts with the container magic
+ */
+bool is_container_file(std::string const& path);
+
+/**
+ * reads an entire container file into memory
+ */
+pressio_data load_container_file(std::string const& path);
+
+#endif /* end of include guard: CONTAINER_H_Q3NVW8TX */
@@ -1,28 +1,35 @@
 #include <libpressio_ext/cpp/libpressio.h>
 #include <libpressio_meta.h>
+#include <algorithm>
 #include <map>
 #include <string_view>
 #include <iostream>
 #include <iomanip>
 #include <functional>
-#include <regex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
 #include <unistd.h>
+#include <std_compat/optional.h>
+#include "graph.h"
+#include "serve.h"
 std::string get_or_default(std::map<std::string, std::string>const& m, std::string const& v, std::string const& default_value) {
     if(auto it = m.find(v); it != m.end()) {
         return it->second;
     }
     return default_value;
 }
-std::string to_id(std::map<std::string, std::string> &m, std::string const& name) {
-    if(auto it = m.find(name); it != m.end()){
-        return it->second;
-    }
-    return m[name] = std::to_string(m.size());
+
+std::string format_ms(double ms) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3) << ms << " ms";
+    return ss.str();
 }
 
 struct graph_printer {
     virtual ~graph_printer()=default;
-    virtual void add_edge(std::string parent_id, std::string child_id)=0;
+    /** ms, if given, is the time spent in the child during a profiled run */
+    virtual void add_edge(std::string parent_id, std::string child_id, compat::optional<double> ms)=0;
     virtual void add_node(std::string node_id, std::vector<std::string> node_text, std::string node_type)=0;
 };
 struct graphviz_printer: public graph_printer {
@@ -34,8 +41,10 @@ struct graphviz_printer: public graph_printer {
         out << "}" << std::endl;
     }
     graphviz_printer(): graphviz_printer(std::cout) {};
-    void add_edge(std::string parent_id, std::string child_id) override {
-        out << parent_id << " -> " << child_id << std::endl;
+    void add_edge(std::string parent_id, std::string child_id, compat::optional<double> ms) override {
+        out << parent_id << " -> " << child_id;
+        if(ms) out << "[label=" << std::quoted(format_ms(*ms)) << ']';
+        out << std::endl;
     }
     void add_node(std::string node_id, std::vector<std::string> node_text, std::string node_type) override {
         std::stringstream ss;
@@ -63,8 +72,10 @@ struct d2_printer: public graph_printer {
     }
     d2_printer(): d2_printer(std::cout) {};
     ~d2_printer() {}
-    void add_edge(std::string parent_id, std::string child_id) override {
-        out << parent_id << " -> " << child_id << std::endl;
+    void add_edge(std::string parent_id, std::string child_id, compat::optional<double> ms) override {
+        out << parent_id << " -> " << child_id;
+        if(ms) out << ": " << format_ms(*ms);
+        out << std::endl;
     }
     void add_node(std::string node_id, std::vector<std::string> node_text, std::string node_type) override {
         std::stringstream ss;
@@ -85,76 +96,199 @@ const std::map<std::string, std::string> d2_printer::shapes {
    {"io", "cylinder"},
    {"dataset", "cloud"},
 };
+std::string json_quote(std::string const& s) {
+    std::ostringstream ss;
+    ss << '"';
+    for (char c : s) {
+        switch(c) {
+            case '"': ss << "\\\""; break;
+            case '\\': ss << "\\\\"; break;
+            case '\n': ss << "\\n"; break;
+            case '\t': ss << "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                } else {
+                    ss << c;
+                }
+        }
+    }
+    ss << '"';
+    return ss.str();
+}
+struct json_printer: public graph_printer {
+    json_printer(std::ostream& out): out(out) {}
+    json_printer(): json_printer(std::cout) {};
+    //nodes are written with their children as an adjacency list, so hold them until the end
+    ~json_printer() {
+        out << "{\"nodes\":[";
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            auto const& node = nodes[i];
+            if(i) out << ',';
+            out << "\n{\"id\":" << json_quote(node.id) << ",\"type\":" << json_quote(node.type) << ",\"labels\":[";
+            for (size_t l = 0; l < node.text.size(); ++l) {
+                if(l) out << ',';
+                out << json_quote(node.text[l]);
+            }
+            out << "],\"children\":[";
+            auto const& node_children = children[node.id];
+            for (size_t c = 0; c < node_children.size(); ++c) {
+                if(c) out << ',';
+                out << json_quote(node_children[c].first);
+            }
+            out << ']';
+            if(std::any_of(node_children.begin(), node_children.end(), [](auto const& c) { return c.second.has_value(); })) {
+                out << ",\"child_ms\":[";
+                for (size_t c = 0; c < node_children.size(); ++c) {
+                    if(c) out << ',';
+                    out << node_children[c].second.value_or(0);
+                }
+                out << ']';
+            }
+            out << '}';
+        }
+        out << "\n]}" << std::endl;
+    }
+    void add_edge(std::string parent_id, std::string child_id, compat::optional<double> ms) override {
+        children[parent_id].emplace_back(std::move(child_id), ms);
+    }
+    void add_node(std::string node_id, std::vector<std::string> node_text, std::string node_type) override {
+        nodes.push_back(node{std::move(node_id), std::move(node_text), std::move(node_type)});
+    }
+    struct node {
+        std::string id;
+        std::vector<std::string> text;
+        std::string type;
+    };
+    std::vector<node> nodes;
+    std::unordered_map<std::string, std::vector<std::pair<std::string, compat::optional<double>>>> children;
+    std::ostream& out;
+};
 std::unique_ptr<graph_printer> make_printer(std::string const& s, std::ostream& out = std::cout) {
     if(s == "d2") return std::make_unique<d2_printer>(out);
     else if(s == "graphviz") return std::make_unique<graphviz_printer>(out);
+    else if(s == "json") return std::make_unique<json_printer>(out);
     else return std::unique_ptr<graph_printer>();
 }
 
-bool starts_with(std::string const& base, std::string const& pattern) {
-    return base.find(pattern) == 0;
+/**
+ * the modules of a compressor tree indexed by name; ids are assigned in the
+ * order the names are first seen
+ */
+struct module_graph {
+    struct node {
+        std::string type, prefix, version;
+        std::vector<size_t> children;
+        std::vector<std::pair<std::string_view, pressio_option const*>> options;
+    };
+
+    size_t id_of(std::string_view name) {
+        auto it = ids.find(name);
+        if(it != ids.end()) return it->second;
+        //the index keys view names which must not move when more names are added
+        names.emplace_back(std::make_unique<std::string>(name));
+        nodes.emplace_back();
+        ids.emplace(*names.back(), nodes.size() - 1);
+        return nodes.size() - 1;
+    }
+
+    std::vector<node> nodes;
+    std::vector<std::unique_ptr<std::string>> names;
+    std::unordered_map<std::string_view, size_t> ids;
+};
+
+/**
+ * splits a fully qualified key "/name:rest" into name and rest
+ */
+bool split_key(std::string const& key, std::string_view& name, std::string_view& rest) {
+    if(key.empty() || key.front() != '/') return false;
+    auto colon = key.find(':');
+    if(colon == std::string::npos) return false;
+    std::string_view view(key);
+    name = view.substr(1, colon - 1);
+    rest = view.substr(colon + 1);
+    return true;
 }
 
-void print_graph(pressio_compressor const& comp, std::string printer_format) {
+void print_graph(pressio_compressor const& comp, std::string printer_format, bool verbose_options, graph_profile const* profile) {
     if(comp->get_name() == "") {
         std::cout << "fully quallify mode is required for graph mode" << std::endl;
-        exit(1);
+        tool_exit(1);
     }
     auto config = comp->get_configuration();
-    auto options = comp->get_options();
-    std::map<std::string, std::string> name_to_id;
-    bool verbose_options = false;
-
-    std::regex child_regex{"/([^:]+):pressio:children"};
-    std::regex type_regex{"/([^:]+):pressio:type"};
-    std::regex prefix_regex{"/([^:]+):pressio:prefix"};
-    std::regex version_regex{"/([^:]+):pressio:version"};
-    std::smatch match;
 
     auto printer = make_printer(printer_format);
     if(!printer) {
         std::cerr << "unknown printer format " << printer_format << std::endl;
-        exit(1);
+        tool_exit(1);
     }
 
-    //collect metadata
-    std::map<std::string, std::string> version, prefix;
+    //one pass over the configuration builds the whole tree
+    module_graph graph;
+    std::vector<size_t> typed;
+    std::string_view name, rest;
     for (auto const& c : config) {
-        if(std::regex_match(c.first, match, prefix_regex)) {
-            prefix[match[1].str()] = c.second.get_value<std::string>();
+        if(!split_key(c.first, name, rest)) continue;
+        if(rest == "pressio:children") {
+            size_t parent = graph.id_of(name);
+            for(auto const& child: c.second.get_value<std::vector<std::string>>()) {
+                size_t child_id = graph.id_of(child);
+                graph.nodes[parent].children.push_back(child_id);
+            }
+        } else if(rest == "pressio:type") {
+            size_t id = graph.id_of(name);
+            graph.nodes[id].type = c.second.get_value<std::string>();
+            typed.push_back(id);
+        } else if(rest == "pressio:prefix") {
+            graph.nodes[graph.id_of(name)].prefix = c.second.get_value<std::string>();
+        } else if(rest == "pressio:version") {
+            graph.nodes[graph.id_of(name)].version = c.second.get_value<std::string>();
         }
-        if(std::regex_match(c.first, match, version_regex)) {
-            version[match[1].str()] = c.second.get_value<std::string>();
+    }
+
+    //and one pass over the options attaches each option to its module
+    pressio_options options;
+    if(verbose_options) {
+        options = comp->get_options();
+        for (auto const& o : options) {
+            if(!split_key(o.first, name, rest)) continue;
+            auto it = graph.ids.find(name);
+            if(it == graph.ids.end()) continue;
+            graph.nodes[it->second].options.emplace_back(rest, &o.second);
         }
     }
 
-    //build graph
-    for (auto const& c : config) {
-        if(std::regex_match(c.first, match, child_regex)) {
-            std::string parent_node_id = to_id(name_to_id, match[1].str());
-            for(auto const& child: c.second.get_value<std::vector<std::string>>()) {
-                std::string child_node_id = to_id(name_to_id, child);
-                printer->add_edge(parent_node_id, child_node_id);
-            }
+    auto profile_of = [&](size_t id) -> node_profile const* {
+        if(!profile) return nullptr;
+        auto it = profile->nodes.find(*graph.names[id]);
+        return (it == profile->nodes.end()) ? nullptr : &it->second;
+    };
+
+    for (size_t parent = 0; parent < graph.nodes.size(); ++parent) {
+        for (size_t child : graph.nodes[parent].children) {
+            compat::optional<double> ms;
+            if(auto const* p = profile_of(child)) ms = p->inclusive_ms;
+            printer->add_edge(std::to_string(parent), std::to_string(child), ms);
         }
-        if(std::regex_match(c.first, match, type_regex)) {
-            std::string name = match[1].str();
-            std::string node_id = to_id(name_to_id, name);
-            std::vector<std::string> labels {name , prefix[name] + '@' + version[name]};
-            if(verbose_options) {
-                for (auto const& o : options) {
-                    if(starts_with(o.first, "/" + name + ":")) {
-                        std::stringstream ss;
-                        ss << o.first.substr(o.first.find(':')+1);
-                        auto option_str =  o.second.as(pressio_option_charptr_type, pressio_conversion_special);
-                        if(option_str.has_value()) {
-                            ss << '=' << option_str.get_value<std::string>();
-                        }
-                        labels.emplace_back(ss.str());
-                    }
-                }
+    }
+    for (size_t id : typed) {
+        auto const& node = graph.nodes[id];
+        std::vector<std::string> labels {*graph.names[id], node.prefix + '@' + node.version};
+        if(auto const* p = profile_of(id)) {
+            labels.emplace_back("calls=" + std::to_string(p->calls));
+            labels.emplace_back("inclusive=" + format_ms(p->inclusive_ms));
+            labels.emplace_back("exclusive=" + format_ms(p->exclusive_ms));
+            labels.emplace_back("bytes in=" + std::to_string(p->input_bytes) + " out=" + std::to_string(p->output_bytes));
+        }
+        for (auto const& [key, option] : node.options) {
+            std::stringstream ss;
+            ss << key;
+            auto option_str = option->as(pressio_option_charptr_type, pressio_conversion_special);
+            if(option_str.has_value()) {
+                ss << '=' << option_str.get_value<std::string>();
             }
-            printer->add_node(node_id, labels, c.second.get_value<std::string>());
+            labels.emplace_back(ss.str());
         }
+        printer->add_node(std::to_string(id), labels, node.type);
     }
 }
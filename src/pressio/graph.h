@@ -2,7 +2,13 @@
 #define GRAPH_H_YJE8ICLX
 
 #include <libpressio_ext/cpp/compressor.h>
-void print_graph(pressio_compressor const& comp, std::string printer_format);
+#include "profile.h"
+/**
+ * prints the module tree of a fully qualified compressor as graphviz, d2, or a
+ * JSON adjacency list; verbose_options adds each module's options to its label
+ * and profile, if given, adds each module's time, bytes, and calls
+ */
+void print_graph(pressio_compressor const& comp, std::string printer_format, bool verbose_options = false, graph_profile const* profile = nullptr);
 
 
 #endif /* end of include guard: GRAPH_H_YJE8ICLX */
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libpressio_ext/cpp/options.h>
+#include "hyperslab_io.h"
+
+namespace {
+
+class posix_hyperslab_reader: public hyperslab_reader {
+  public:
+  posix_hyperslab_reader(std::string const& path, pressio_dtype dtype, std::vector<size_t> const& dims):
+    fd(open(path.c_str(), O_RDONLY)), dtype(dtype), dims(dims)
+  {
+    if(fd == -1) {
+      throw std::runtime_error("failed to open " + path);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+  ~posix_hyperslab_reader() {
+    close(fd);
+  }
+  posix_hyperslab_reader(posix_hyperslab_reader const&)=delete;
+  posix_hyperslab_reader& operator=(posix_hyperslab_reader const&)=delete;
+
+  pressio_data read(hyperslab const& slab) override {
+    pressio_data out = pressio_data::owning(dtype, slab.count);
+    read_into(slab, out);
+    return out;
+  }
+
+  void read_into(hyperslab const& slab, pressio_data& out) override {
+    const size_t ndims = dims.size();
+    const size_t elem_size = pressio_dtype_size(dtype);
+    if(slab.count.size() != ndims) {
+      throw std::runtime_error("hyperslab does not match the input dimensions");
+    }
+    //coalesce leading dimensions that are selected in full into one contiguous run
+    size_t run_dims = 1;
+    size_t run = slab.count[0];
+    while(run_dims < ndims && slab.count[run_dims - 1] == dims[run_dims - 1]) {
+      run *= slab.count[run_dims];
+      ++run_dims;
+    }
+
+    char* dst = static_cast<char*>(out.data());
+    std::vector<size_t> index(ndims, 0);
+    while(true) {
+      size_t offset = 0;
+      for (size_t i = ndims; i-- > 0;) {
+        offset = offset * dims[i] + slab.start[i] + index[i];
+      }
+      pread_fully(dst, run * elem_size, offset * elem_size);
+      dst += run * elem_size;
+
+      size_t dim = run_dims;
+      for (; dim < ndims; ++dim) {
+        if(++index[dim] < slab.count[dim]) break;
+        index[dim] = 0;
+      }
+      if(dim >= ndims) break;
+    }
+  }
+
+  private:
+  void pread_fully(char* ptr, size_t remaining, off_t offset) {
+    while(remaining > 0) {
+      ssize_t n = pread(fd, ptr, remaining, offset);
+      if(n <= 0) {
+        throw std::runtime_error("failed to read input, the file may be shorter than its dimensions");
+      }
+      ptr += n;
+      offset += n;
+      remaining -= n;
+    }
+  }
+
+  int fd;
+  pressio_dtype dtype;
+  std::vector<size_t> dims;
+};
+
+class hdf5_hyperslab_reader: public hyperslab_reader {
+  public:
+  hdf5_hyperslab_reader(pressio_io& io): io(io) {}
+
+  pressio_data read(hyperslab const& slab) override {
+    //HDF5 lists the slowest dimension first
+    auto as_hdf5 = [](std::vector<size_t> const& v) {
+      std::vector<uint64_t> reversed(v.rbegin(), v.rend());
+      return pressio_data::copy(pressio_uint64_dtype, reversed.data(), {reversed.size()});
+    };
+    std::vector<size_t> ones(slab.count.size(), 1);
+    if(io->set_options({
+          {"hdf5:file_start", as_hdf5(slab.start)},
+          {"hdf5:file_count", as_hdf5(slab.count)},
+          {"hdf5:file_stride", as_hdf5(ones)},
+          {"hdf5:file_block", as_hdf5(ones)},
+          })) {
+      throw std::runtime_error(io->error_msg());
+    }
+    pressio_data* data = io->read(nullptr);
+    if(data == nullptr) {
+      throw std::runtime_error(io->error_msg());
+    }
+    pressio_data result = std::move(*data);
+    delete data;
+    return result;
+  }
+
+  private:
+  pressio_io& io;
+};
+
+bool is_hdf5(io_description const& desc) {
+  return desc.format && *desc.format == "hdf5";
+}
+
+/**
+ * by_extension only reads raw binary for these extensions; other files have
+ * headers that would be taken as data
+ */
+bool has_raw_extension(std::string const& path) {
+  const std::string name = path.substr(path.rfind('/') + 1);
+  const size_t dot = name.rfind('.');
+  if(dot == std::string::npos) return false;
+  const std::string extension = name.substr(dot);
+  return extension == ".bin" || extension == ".dat" || extension == ".raw";
+}
+
+}
+
+bool is_raw_input(io_description const& desc) {
+  if(desc.format && *desc.format == "by_extension") {
+    return desc.path && has_raw_extension(*desc.path);
+  }
+  return !desc.format || *desc.format == "posix";
+}
+
+void hyperslab_reader::read_into(hyperslab const& slab, pressio_data& out) {
+  pressio_data data = read(slab);
+  std::memcpy(out.data(), data.data(), std::min(out.size_in_bytes(), data.size_in_bytes()));
+}
+
+std::unique_ptr<hyperslab_reader> make_hyperslab_reader(pressio_io& io, io_description const& desc) {
+  if(is_hdf5(desc)) {
+    return std::make_unique<hdf5_hyperslab_reader>(io);
+  } else if(is_raw_input(desc)) {
+    if(!desc.path || !desc.dtype || desc.dims.empty()) {
+      throw std::runtime_error("partial reads of raw binary inputs require -i, -t, and -d");
+    }
+    return std::make_unique<posix_hyperslab_reader>(*desc.path, *desc.dtype, desc.dims);
+  }
+  throw std::runtime_error("partial reads are only supported for raw binary and HDF5 inputs, not " + *desc.format +
+      (desc.path ? " (" + *desc.path + ")" : std::string()));
+}
+
+hyperslab resolve_selection(io_description const& desc) {
+  if(!desc.dims.empty()) {
+    return resolve_hyperslab(desc.selection, desc.dims);
+  }
+  //without -d the selection itself has to bound every dimension
+  std::vector<size_t> dims;
+  for (auto const& range : desc.selection) {
+    if(!range.end) {
+      throw std::runtime_error("selections with open ended ranges require -d");
+    }
+    dims.push_back(*range.end);
+  }
+  return resolve_hyperslab(desc.selection, dims);
+}
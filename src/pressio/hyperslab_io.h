@@ -0,0 +1,38 @@
+#ifndef HYPERSLAB_IO_H_V0CJ2MQD
+#define HYPERSLAB_IO_H_V0CJ2MQD
+#include <memory>
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/io.h>
+#include <utils/hyperslab.h>
+#include "cmdline.h"
+
+/**
+ * reads a hyperslab of an input without reading the rest of it from disk
+ */
+class hyperslab_reader {
+  public:
+  virtual ~hyperslab_reader()=default;
+  /** reads slab into a newly allocated buffer */
+  virtual pressio_data read(hyperslab const& slab) = 0;
+  /** reads slab into out which must already have slab.count dimensions */
+  virtual void read_into(hyperslab const& slab, pressio_data& out);
+};
+
+/**
+ * true if the input is a raw binary file: posix, or by_extension with a
+ * .bin, .dat, or .raw path
+ */
+bool is_raw_input(io_description const& desc);
+
+/**
+ * creates a reader for a raw binary input (-i) or a HDF5 dataset (-I);
+ * throws if the input format cannot be read partially
+ */
+std::unique_ptr<hyperslab_reader> make_hyperslab_reader(pressio_io& io, io_description const& desc);
+
+/**
+ * resolves the -x selection of an input, or the whole input if there is none
+ */
+hyperslab resolve_selection(io_description const& desc);
+
+#endif /* end of include guard: HYPERSLAB_IO_H_V0CJ2MQD */
@@ -0,0 +1,75 @@
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "input_list.h"
+
+namespace {
+
+std::vector<size_t> parse_dims(std::string const& value) {
+  std::vector<size_t> dims;
+  std::istringstream ss(value);
+  std::string dim;
+  while(std::getline(ss, dim, ',')) {
+    //stoull would wrap a negative dimension around instead of rejecting it
+    if(dim.empty() || !std::isdigit(static_cast<unsigned char>(dim.front()))) throw std::invalid_argument(dim);
+    size_t pos = 0;
+    dims.push_back(std::stoull(dim, &pos));
+    if(pos != dim.size()) throw std::invalid_argument(dim);
+  }
+  return dims;
+}
+
+input_list_entry parse_entry(std::string const& line) {
+  input_list_entry entry;
+  std::istringstream fields(line);
+  std::string field;
+  while(fields >> field) {
+    auto sep = field.find('=');
+    if(sep == std::string::npos) {
+      throw std::runtime_error("expected key=value, got " + field);
+    }
+    const std::string key = field.substr(0, sep);
+    std::string value = field.substr(sep + 1);
+    if(key == "input") entry.input = std::move(value);
+    else if(key == "dtype") entry.dtype = std::move(value);
+    else if(key == "dims") {
+      try {
+        entry.dims = parse_dims(value);
+      } catch(std::logic_error const&) {
+        throw std::runtime_error("invalid dims " + value);
+      }
+    }
+    else if(key == "format") entry.format = std::move(value);
+    else if(key == "compressed") entry.compressed = std::move(value);
+    else if(key == "compressed_format") entry.compressed_format = std::move(value);
+    else if(key == "decompressed") entry.decompressed = std::move(value);
+    else if(key == "decompressed_format") entry.decompressed_format = std::move(value);
+    else throw std::runtime_error("unknown key " + key);
+  }
+  if(entry.input.empty()) {
+    throw std::runtime_error("every input requires input=<path>");
+  }
+  return entry;
+}
+
+}
+
+std::vector<input_list_entry> load_input_list(std::string const& path) {
+  std::ifstream in(path);
+  if(!in) {
+    throw std::runtime_error("failed to open " + path);
+  }
+  std::vector<input_list_entry> entries;
+  std::string line;
+  for (size_t line_number = 1; std::getline(in, line); ++line_number) {
+    auto first = line.find_first_not_of(" \t\r");
+    if(first == std::string::npos || line[first] == '#') continue;
+    try {
+      entries.emplace_back(parse_entry(line));
+    } catch(std::runtime_error const& ex) {
+      throw std::runtime_error(path + ":" + std::to_string(line_number) + ": " + ex.what());
+    }
+  }
+  return entries;
+}
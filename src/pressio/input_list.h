@@ -0,0 +1,30 @@
+#ifndef INPUT_LIST_H_Q2HV6DNM
+#define INPUT_LIST_H_Q2HV6DNM
+#include <string>
+#include <vector>
+#include <std_compat/optional.h>
+
+/**
+ * one input group of a -K input manifest; unset fields keep the values given
+ * on the command line
+ */
+struct input_list_entry {
+  std::string input;
+  compat::optional<std::string> dtype;
+  std::vector<size_t> dims;
+  compat::optional<std::string> format;
+  compat::optional<std::string> compressed;
+  compat::optional<std::string> compressed_format;
+  compat::optional<std::string> decompressed;
+  compat::optional<std::string> decompressed_format;
+};
+
+/**
+ * reads an input manifest: one input per line as whitespace separated
+ * key=value fields (input, dtype, dims=<d0>,<d1>,..., format, compressed,
+ * compressed_format, decompressed, decompressed_format); blank lines and lines
+ * starting with # are skipped.  Throws std::runtime_error naming the bad line.
+ */
+std::vector<input_list_entry> load_input_list(std::string const& path);
+
+#endif /* end of include guard: INPUT_LIST_H_Q2HV6DNM */
@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <link.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <libpressio.h>
+#include "manifest.h"
+
+namespace {
+
+uint64_t fnv1a(std::string const& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+int describe_object(dl_phdr_info* info, size_t, void* data) {
+  auto& out = *static_cast<std::ostringstream*>(data);
+  struct stat st;
+  if(info->dlpi_name && *info->dlpi_name && stat(info->dlpi_name, &st) == 0) {
+    out << info->dlpi_name << ':' << st.st_size << ':' << st.st_mtime << '\n';
+  }
+  return 0;
+}
+
+compat::optional<std::string> cache_dir() {
+  if(std::getenv("LIBPRESSIO_TOOLS_NO_CACHE")) return compat::nullopt;
+  if(const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+    if(*xdg) return std::string(xdg) + "/libpressio_tools";
+  }
+  if(const char* home = std::getenv("HOME")) {
+    if(*home) return std::string(home) + "/.cache/libpressio_tools";
+  }
+  return compat::nullopt;
+}
+
+compat::optional<std::string> manifest_path() {
+  auto dir = cache_dir();
+  if(!dir) return compat::nullopt;
+  return *dir + "/versions.manifest";
+}
+
+}
+
+std::string manifest_key() {
+  std::ostringstream desc;
+  desc << pressio_version() << '\n' << pressio_supported_compressors() << '\n';
+  dl_iterate_phdr(describe_object, &desc);
+  std::ostringstream key;
+  key << std::hex << fnv1a(desc.str());
+  return key.str();
+}
+
+compat::optional<version_manifest> load_version_manifest() {
+  auto path = manifest_path();
+  if(!path) return compat::nullopt;
+  std::ifstream in(*path);
+  std::string key;
+  if(!(in >> key) || key != manifest_key()) return compat::nullopt;
+  in.ignore(1);
+  version_manifest versions;
+  std::string line;
+  while(std::getline(in, line)) {
+    auto tab = line.find('\t');
+    if(tab == std::string::npos) return compat::nullopt;
+    versions.emplace_back(line.substr(0, tab), line.substr(tab + 1));
+  }
+  return versions;
+}
+
+void save_version_manifest(version_manifest const& versions) {
+  auto dir = cache_dir();
+  auto path = manifest_path();
+  if(!dir || !path) return;
+  //create $XDG_CACHE_HOME itself if needed, then our directory
+  mkdir(dir->substr(0, dir->rfind('/')).c_str(), 0755);
+  mkdir(dir->c_str(), 0755);
+  //write to a temporary file and rename so concurrent runs never see a partial manifest
+  const std::string tmp = *path + "." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp);
+    out << manifest_key() << '\n';
+    for (auto const& version : versions) {
+      out << version.first << '\t' << version.second << '\n';
+    }
+    if(!out) {
+      std::remove(tmp.c_str());
+      return;
+    }
+  }
+  if(std::rename(tmp.c_str(), path->c_str()) != 0) {
+    std::remove(tmp.c_str());
+  }
+}
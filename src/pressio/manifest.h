@@ -0,0 +1,32 @@
+#ifndef MANIFEST_H_E7PX3KDA
+#define MANIFEST_H_E7PX3KDA
+#include <string>
+#include <utility>
+#include <vector>
+#include <std_compat/optional.h>
+
+/**
+ * the version of each compressor plugin, in registry order
+ */
+using version_manifest = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * a key that changes whenever any loaded shared library or the set of
+ * registered compressors changes
+ */
+std::string manifest_key();
+
+/**
+ * the cached versions for the current manifest_key, if they have been saved
+ * before; the cache lives in $XDG_CACHE_HOME/libpressio_tools (or
+ * ~/.cache/libpressio_tools) and is disabled if LIBPRESSIO_TOOLS_NO_CACHE is set
+ */
+compat::optional<version_manifest> load_version_manifest();
+
+/**
+ * caches versions for the current manifest_key; failures are ignored since
+ * the cache is only an optimization
+ */
+void save_version_manifest(version_manifest const& versions);
+
+#endif /* end of include guard: MANIFEST_H_E7PX3KDA */
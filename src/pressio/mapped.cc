@@ -0,0 +1,112 @@
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped.h"
+
+namespace {
+const std::string shared_memory_prefix = "shm:";
+
+void unmap_data(void* data, void* metadata) {
+  auto length = static_cast<size_t*>(metadata);
+  munmap(data, *length);
+  delete length;
+}
+
+/**
+ * opens a file, or a POSIX shared memory segment for shm: paths
+ */
+int open_path(std::string const& path, int flags, mode_t mode = 0) {
+  if(is_shared_memory_path(path)) {
+    std::string name = path.substr(shared_memory_prefix.size());
+    if(name.empty() || name.front() != '/') name.insert(0, "/");
+    return shm_open(name.c_str(), flags, mode);
+  }
+  return open(path.c_str(), flags, mode);
+}
+}
+
+bool is_shared_memory_path(std::string const& path) {
+  return path.compare(0, shared_memory_prefix.size(), shared_memory_prefix) == 0;
+}
+
+pressio_data map_input_file(std::string const& path, compat::optional<pressio_dtype> const& dtype, std::vector<size_t> dims, MapHint hint) {
+  const pressio_dtype type = dtype.value_or(pressio_byte_dtype);
+  int fd = open_path(path, O_RDONLY);
+  if(fd == -1) {
+    throw std::runtime_error("failed to open " + path);
+  }
+  struct stat info;
+  if(fstat(fd, &info) == -1) {
+    close(fd);
+    throw std::runtime_error("failed to stat " + path);
+  }
+  const size_t file_size = info.st_size;
+  if(dims.empty()) {
+    dims.push_back(file_size / pressio_dtype_size(type));
+  }
+  const size_t length = std::accumulate(dims.begin(), dims.end(), pressio_dtype_size(type), std::multiplies<>{});
+  if(length > file_size) {
+    close(fd);
+    throw std::runtime_error(path + " is smaller than its dimensions");
+  }
+  if(length == 0) {
+    close(fd);
+    return pressio_data::owning(type, dims);
+  }
+
+  int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  if(hint == MapHint::Populate) flags |= MAP_POPULATE;
+#endif
+  //writable so that compressors that modify their input only touch private copies of those pages
+  void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, fd, 0);
+  close(fd);
+  if(addr == MAP_FAILED) {
+    throw std::runtime_error("failed to map " + path);
+  }
+  switch(hint) {
+    case MapHint::WillNeed:
+      madvise(addr, length, MADV_WILLNEED);
+      break;
+    case MapHint::Sequential:
+      madvise(addr, length, MADV_SEQUENTIAL);
+      break;
+    default:
+      (void)0;
+  }
+  return pressio_data::move(type, addr, dims, unmap_data, new size_t(length));
+}
+
+pressio_data map_output_file(std::string const& path, pressio_dtype dtype, std::vector<size_t> const& dims) {
+  const size_t length = std::accumulate(dims.begin(), dims.end(), pressio_dtype_size(dtype), std::multiplies<>{});
+  int fd = open_path(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(fd == -1) {
+    throw std::runtime_error("failed to open " + path + " for writing");
+  }
+  if(ftruncate(fd, length) == -1) {
+    close(fd);
+    throw std::runtime_error("failed to resize " + path);
+  }
+  if(length == 0) {
+    close(fd);
+    return pressio_data::owning(dtype, dims);
+  }
+  void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(addr == MAP_FAILED) {
+    throw std::runtime_error("failed to map " + path);
+  }
+  return pressio_data::move(dtype, addr, dims, unmap_data, new size_t(length));
+}
+
+void publish_to_shared_memory(std::string const& path, pressio_data const& data) {
+  pressio_data segment = map_output_file(path, pressio_byte_dtype, {data.size_in_bytes()});
+  if(data.size_in_bytes() > 0) {
+    std::memcpy(segment.data(), data.data(), data.size_in_bytes());
+  }
+}
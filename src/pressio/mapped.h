@@ -0,0 +1,34 @@
+#ifndef MAPPED_H_R2K8PZ4E
+#define MAPPED_H_R2K8PZ4E
+#include <string>
+#include <vector>
+#include <std_compat/optional.h>
+#include <libpressio_ext/cpp/data.h>
+#include "cmdline.h"
+
+/**
+ * true for paths of the form shm:<name> which name a POSIX shared memory
+ * segment (shm_open) rather than a file
+ */
+bool is_shared_memory_path(std::string const& path);
+
+/**
+ * maps a raw binary file or shared memory segment into memory copy-on-write; the mapping is released
+ * when the last copy of the returned data is freed.  Without a dtype the file
+ * is mapped as bytes, and without dims it is mapped as a 1d array.
+ */
+pressio_data map_input_file(std::string const& path, compat::optional<pressio_dtype> const& dtype, std::vector<size_t> dims, MapHint hint);
+
+/**
+ * creates or truncates the file or shared memory segment at path to hold dims
+ * entries of dtype and maps it shared so that writes to the returned data land
+ * directly in the file
+ */
+pressio_data map_output_file(std::string const& path, pressio_dtype dtype, std::vector<size_t> const& dims);
+
+/**
+ * creates or truncates the shared memory segment at path and copies data into it
+ */
+void publish_to_shared_memory(std::string const& path, pressio_data const& data);
+
+#endif /* end of include guard: MAPPED_H_R2K8PZ4E */
@@ -1,52 +1,94 @@
+#include <cstdlib>
 #include <iostream>
+#include <pressio_version.h>
 #include <libpressio_ext/cpp/libpressio.h>
 #include <std_compat/optional.h>
 #include <utils/string_options.h>
+#include <utils/option_index.h>
 #include <utility>
 #include <map>
 #include "options.h"
+#include "serve.h"
 
-int set_options_from_multimap(pressio_configurable& c, std::multimap<std::string,std::string> const& user_options, const char* configurable_type, compat::optional<pressio_options>& out) {
-  pressio_options configurable_options = c.get_options();
+#if LIBPRESSIO_HAS_JSON
+#include <libpressio_ext/json/pressio_options_json.h>
+#endif
+
+pressio_options resolve_options_from_multimap(option_index const& index, std::multimap<std::string,std::string> const& user_options, const char* configurable_type) {
   pressio_options new_options;
   auto presssio_user_opts = options_from_multimap(user_options);
   for (auto it =  presssio_user_opts.begin(); it != presssio_user_opts.end(); ++it) {
     auto const& setting = it->first;
     auto const& value = it->second;
-    auto option_status = configurable_options.key_status(setting);
-    if(option_status == pressio_options_key_does_not_exist) {
-          if(rank == 0) {
-            std::cerr << "non existent option for the " << configurable_type << " : " << setting  << std::endl;
-          }
-          exit(EXIT_FAILURE);
-    }
-    auto option = configurable_options.get(setting);
-    new_options.set(setting, std::move(option));
-    auto status = new_options.cast_set(setting, value, pressio_conversion_special);
+    pressio_option option;
+    auto status = index.cast(setting, value, option);
     switch(status) {
       case pressio_options_key_does_not_exist:
         {
           if(rank == 0) {
             std::cerr << "non existent option for the " << configurable_type << " : " << setting  << std::endl;
           }
-          exit(EXIT_FAILURE);
+          tool_exit(EXIT_FAILURE);
         }
       case pressio_options_key_exists:
         {
           if(rank == 0) {
-            auto type = new_options.get(setting).type();
+            auto type = index.type(setting);
             std::cerr << "cannot convert to value " << value << " to correct type for setting " << setting  <<
               " which has type " << type 
               << std::endl;
           }
-          exit(EXIT_FAILURE);
+          tool_exit(EXIT_FAILURE);
         }
       default:
-        (void)0;
+        new_options.set(setting, std::move(option));
     }
   }
+  return new_options;
+}
+
+int set_options_from_multimap(pressio_configurable& c, std::multimap<std::string,std::string> const& user_options, const char* configurable_type, compat::optional<pressio_options>& out, option_index& index) {
+  const bool first_application = !index.indexed();
+  if(first_application) {
+    index = option_index(c.get_options());
+  }
+  pressio_options new_options = resolve_options_from_multimap(index, user_options, configurable_type);
   if(out) {
       out->copy_from(new_options);
   }
-  return c.set_options(new_options);
+  if(first_application) {
+    return apply_options(c, new_options, index);
+  }
+  return apply_changed_options(c, new_options, index);
+}
+
+int set_options_from_multimap(pressio_configurable& c, std::multimap<std::string,std::string> const& user_options, const char* configurable_type, compat::optional<pressio_options>& out) {
+  option_index index;
+  return set_options_from_multimap(c, user_options, configurable_type, out, index);
+}
+
+std::string options_to_string(pressio_options const& options) {
+#if LIBPRESSIO_HAS_JSON
+  char* json = pressio_options_to_json(nullptr, &options);
+  std::string str = json;
+  free(json);
+  return str;
+#else
+  (void)options;
+  return "";
+#endif
+}
+
+compat::optional<pressio_options> options_from_string(std::string const& str) {
+#if LIBPRESSIO_HAS_JSON
+  if(str.empty()) return compat::nullopt;
+  pressio_options* options = pressio_options_new_json(nullptr, str.c_str());
+  if(!options) return compat::nullopt;
+  pressio_options result = std::move(*options);
+  pressio_options_free(options);
+  return result;
+#else
+  (void)str;
+  return compat::nullopt;
+#endif
 }
@@ -2,6 +2,20 @@
 #include <string>
 #include <libpressio_ext/cpp/options.h>
 #include <std_compat/optional.h>
+#include <utils/option_index.h>
 struct pressio_configurable;
 int set_options_from_multimap(pressio_configurable& c, std::multimap<std::string,std::string> const& user_options, const char* configurable_type, compat::optional<pressio_options>& out);
+/**
+ * like set_options_from_multimap, but builds index on first use, when every
+ * requested option is set, and afterwards only sets the options that changed
+ * since the previous call
+ */
+int set_options_from_multimap(pressio_configurable& c, std::multimap<std::string,std::string> const& user_options, const char* configurable_type, compat::optional<pressio_options>& out, option_index& index);
+/**
+ * converts user_options to the types recorded in index, exiting if an option
+ * does not exist or cannot be converted
+ */
+pressio_options resolve_options_from_multimap(option_index const& index, std::multimap<std::string,std::string> const& user_options, const char* configurable_type);
+std::string options_to_string(pressio_options const& options);
+compat::optional<pressio_options> options_from_string(std::string const& str);
 extern int rank;
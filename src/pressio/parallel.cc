@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <std_compat/optional.h>
+#include <libpressio_ext/cpp/options.h>
+#include "options.h"
+#include "parallel.h"
+#include "serve.h"
+
+bool is_thread_safe(pressio_compressor& compressor) {
+  int32_t safety = pressio_thread_safety_single;
+  if(compressor->get_configuration().get("pressio:thread_safe", &safety) != pressio_options_key_set) {
+    return false;
+  }
+  return safety == pressio_thread_safety_multiple;
+}
+
+void parallel_for_each(pressio_compressor& compressor, size_t threads, size_t n,
+    std::function<int(pressio_compressor&, size_t)> const& task, bool private_instances) {
+  const size_t num_workers = std::max<size_t>(1, std::min(threads, n));
+  const bool shared = !private_instances && is_thread_safe(compressor);
+  std::vector<pressio_compressor> clones;
+  if(!shared) {
+    for (size_t w = 1; w < num_workers; ++w) {
+      clones.emplace_back(compressor->clone());
+    }
+  }
+
+  std::atomic<size_t> next{0};
+  std::mutex error_mutex;
+  compat::optional<std::pair<int, std::string>> error;
+  auto fail = [&](int code, std::string const& msg) {
+    std::lock_guard<std::mutex> guard(error_mutex);
+    if(!error) error = std::make_pair(code, msg);
+    next = n;
+  };
+  //errors are reported once every worker has stopped rather than exiting out from under them
+  auto work = [&](pressio_compressor& worker) {
+    for (size_t i = next++; i < n; i = next++) {
+      try {
+        if(task(worker, i)) {
+          fail(worker->error_code(), worker->error_msg());
+        }
+      } catch(std::exception const& ex) {
+        fail(EXIT_FAILURE, ex.what());
+      } catch(request_ended const& ended) {
+        //the task already reported why
+        fail(ended.status, {});
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t w = 1; w < num_workers; ++w) {
+    workers.emplace_back(work, std::ref(shared ? compressor : clones[w - 1]));
+  }
+  work(compressor);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  if(error) {
+    if(rank == 0 && !error->second.empty()) {
+      std::cerr << error->second << std::endl;
+    }
+    tool_exit(error->first);
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef PARALLEL_H_T5MB7XQA
+#define PARALLEL_H_T5MB7XQA
+#include <functional>
+#include <libpressio_ext/cpp/compressor.h>
+
+/**
+ * true if the compressor reports pressio:thread_safe as multiple
+ */
+bool is_thread_safe(pressio_compressor& compressor);
+
+/**
+ * runs task(worker, i) for each i in [0, n) on up to threads threads.
+ *
+ * workers share compressor if it is thread safe and private_instances is
+ * false, otherwise each additional worker uses its own clone. A non-zero return from task is reported from the
+ * worker's compressor, an exception from task by its message; either stops the remaining tasks and exits once
+ * all workers finish.
+ */
+void parallel_for_each(pressio_compressor& compressor, size_t threads, size_t n,
+    std::function<int(pressio_compressor&, size_t)> const& task, bool private_instances = false);
+
+#endif /* end of include guard: PARALLEL_H_T5MB7XQA */
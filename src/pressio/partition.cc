@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include "partition.h"
+
+namespace {
+
+class mpi_file {
+  public:
+  mpi_file(std::string const& path, MPI_Comm comm) {
+    if(MPI_File_open(comm, path.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+      throw std::runtime_error("failed to open " + path + " for writing");
+    }
+  }
+  ~mpi_file() {
+    MPI_File_close(&fh);
+  }
+  mpi_file(mpi_file const&)=delete;
+  mpi_file& operator=(mpi_file const&)=delete;
+
+  /** collective */
+  void resize(uint64_t size) {
+    if(MPI_File_set_size(fh, size) != MPI_SUCCESS) {
+      throw std::runtime_error("failed to resize output");
+    }
+  }
+
+  void write_at(uint64_t offset, const void* data, uint64_t size) {
+    //MPI counts are ints, so large pieces are written in several calls
+    const char* ptr = static_cast<const char*>(data);
+    while(size > 0) {
+      const int count = static_cast<int>(std::min<uint64_t>(size, INT_MAX));
+      if(MPI_File_write_at(fh, offset, ptr, count, MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS) {
+        throw std::runtime_error("failed to write output");
+      }
+      ptr += count;
+      offset += count;
+      size -= count;
+    }
+  }
+
+  private:
+  MPI_File fh;
+};
+
+}
+
+void write_partitioned_container(std::string const& path, container_header const& header, pressio_data const& block, MPI_Comm comm) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  uint64_t block_size = block.size_in_bytes();
+  std::vector<uint64_t> sizes(size);
+  MPI_Allgather(&block_size, 1, MPI_UINT64_T, sizes.data(), 1, MPI_UINT64_T, comm);
+
+  const std::string head = container_header_bytes(header);
+  const uint64_t slowest = header.dims.empty() ? 0 : header.dims.back();
+  const uint64_t num_blocks = (header.block_extent == 0) ? 0 : (slowest + header.block_extent - 1) / header.block_extent;
+  std::vector<container_block> index;
+  uint64_t offset = head.size(), block_offset = 0;
+  for (int r = 0; r < size; ++r) {
+    if(r == rank) block_offset = offset;
+    if(static_cast<uint64_t>(r) < num_blocks) index.push_back({offset, sizes[r]});
+    offset += sizes[r];
+  }
+  const std::string tail = container_index_bytes(index, offset);
+
+  mpi_file file(path, comm);
+  file.resize(offset + tail.size());
+  if(rank == 0) {
+    file.write_at(0, head.data(), head.size());
+    file.write_at(offset, tail.data(), tail.size());
+  }
+  file.write_at(block_offset, block.data(), block_size);
+}
+
+void write_partitioned_raw(std::string const& path, std::vector<std::pair<uint64_t, pressio_data>> const& pieces, uint64_t total_size, MPI_Comm comm) {
+  mpi_file file(path, comm);
+  file.resize(total_size);
+  for (auto const& piece : pieces) {
+    file.write_at(piece.first, piece.second.data(), piece.second.size_in_bytes());
+  }
+}
@@ -0,0 +1,23 @@
+#ifndef PARTITION_H_J4WD9CFE
+#define PARTITION_H_J4WD9CFE
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+#include <libpressio_ext/cpp/data.h>
+#include "container.h"
+
+/**
+ * collectively writes a container where rank r contributes block r; ranks
+ * beyond the number of blocks in header contribute an empty block
+ */
+void write_partitioned_container(std::string const& path, container_header const& header, pressio_data const& block, MPI_Comm comm);
+
+/**
+ * collectively writes a raw file of total_size bytes where each rank writes
+ * its pieces at their byte offsets
+ */
+void write_partitioned_raw(std::string const& path, std::vector<std::pair<uint64_t, pressio_data>> const& pieces, uint64_t total_size, MPI_Comm comm);
+
+#endif /* end of include guard: PARTITION_H_J4WD9CFE */
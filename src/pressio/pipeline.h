@@ -0,0 +1,114 @@
+#ifndef PIPELINE_H_W2LF6NCY
+#define PIPELINE_H_W2LF6NCY
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <std_compat/optional.h>
+
+/**
+ * a blocking queue that holds at most capacity items
+ */
+template <class T>
+class bounded_queue {
+  public:
+  explicit bounded_queue(size_t capacity): capacity(capacity ? capacity : 1) {}
+
+  /** blocks while the queue is full; returns false if the queue was closed */
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [this]{ return closed || items.size() < capacity; });
+    if(closed) return false;
+    items.emplace_back(std::move(item));
+    not_empty.notify_one();
+    return true;
+  }
+
+  /** blocks while the queue is empty; returns nullopt once closed and drained */
+  compat::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [this]{ return closed || !items.empty(); });
+    if(items.empty()) return compat::nullopt;
+    T item = std::move(items.front());
+    items.pop_front();
+    not_full.notify_one();
+    return item;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_full.notify_all();
+    not_empty.notify_all();
+  }
+
+  private:
+  size_t capacity;
+  bool closed = false;
+  std::deque<T> items;
+  std::mutex mutex;
+  std::condition_variable not_full, not_empty;
+};
+
+/**
+ * runs read(i), process(i, read_result) and write(i, process_result) for each
+ * i in [0, n) as three concurrent stages connected by queues of at most depth
+ * items, so that reading, processing, and writing of neighboring items
+ * overlap.  The first exception thrown by any stage stops the pipeline and is
+ * rethrown by the caller's thread.
+ */
+template <class Read, class Process, class Write>
+void run_pipeline(size_t n, size_t depth, Read&& read, Process&& process, Write&& write) {
+  using read_t = decltype(read(size_t{0}));
+  using process_t = decltype(process(size_t{0}, std::declval<read_t>()));
+  bounded_queue<std::pair<size_t, read_t>> to_process(depth);
+  bounded_queue<std::pair<size_t, process_t>> to_write(depth);
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto fail = [&](std::exception_ptr ex) {
+    {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if(!error) error = ex;
+    }
+    to_process.close();
+    to_write.close();
+  };
+
+  std::thread reader([&]{
+    try {
+      for (size_t i = 0; i < n; ++i) {
+        if(!to_process.push(std::make_pair(i, read(i)))) break;
+      }
+    } catch(...) {
+      fail(std::current_exception());
+    }
+    to_process.close();
+  });
+  std::thread writer([&]{
+    try {
+      while(auto item = to_write.pop()) {
+        write(item->first, std::move(item->second));
+      }
+    } catch(...) {
+      fail(std::current_exception());
+    }
+  });
+
+  try {
+    while(auto item = to_process.pop()) {
+      if(!to_write.push(std::make_pair(item->first, process(item->first, std::move(item->second))))) break;
+    }
+  } catch(...) {
+    fail(std::current_exception());
+  }
+  to_write.close();
+  reader.join();
+  writer.join();
+  if(error) std::rethrow_exception(error);
+}
+
+#endif /* end of include guard: PIPELINE_H_W2LF6NCY */
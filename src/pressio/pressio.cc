@@ -1,10 +1,19 @@
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <regex>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <fstream>
+#include <functional>
+#include <numeric>
+#include <map>
+#include <mutex>
 #include <set>
 
 #include <libpressio.h>
@@ -26,6 +35,7 @@
 #if LIBPRESSIO_TOOLS_HAS_MPI
 #include <mpi.h>
 #include <libdistributed_comm.h>
+#include "partition.h"
 #include <libpressio_ext/cpp/serializable.h>
 #endif
 
@@ -33,8 +43,20 @@
 #include <libpressio_ext/json/pressio_options_json.h>
 #endif
 
+#include "bench.h"
+#include "binary_config.h"
 #include "cmdline.h"
+#include "container.h"
 #include "graph.h"
+#include "hyperslab_io.h"
+#include "manifest.h"
+#include "mapped.h"
+#include "parallel.h"
+#include "profile.h"
+#include "pipeline.h"
+#include "serve.h"
+#include "stream.h"
+#include "watch.h"
 
 int rank = 0;
 
@@ -140,21 +162,58 @@ void print_help(pressio_compressor & compressor, Action action) {
 
 }
 
-void print_versions(pressio& library) {
+void print_versions(pressio& library, cmdline_options& opts) {
   if(rank == 0) {
     std::cerr << "libpressio version: " << pressio_version() << std::endl;
-    std::istringstream compressors{std::string(pressio_supported_compressors())};
-    std::string compressor;
-    while(compressors >> compressor)
+    compat::optional<version_manifest> versions;
     {
-      auto cmp = library.get_compressor(compressor);
-      std::cerr << compressor << ' ' << cmp->version() << std::endl;
+      phase_timer timer(opts.startup_phases, "load version manifest");
+      versions = load_version_manifest();
     }
+    if(!versions) {
+      //instantiating every compressor is slow, so remember the answer for this set of libraries
+      versions.emplace();
+      std::istringstream compressors{std::string(pressio_supported_compressors())};
+      std::string compressor;
+      while(compressors >> compressor)
+      {
+        phase_timer timer(opts.startup_phases, "instantiate " + compressor);
+        auto cmp = library.get_compressor(compressor);
+        versions->emplace_back(compressor, cmp ? cmp->version() : "");
+      }
+      save_version_manifest(*versions);
+    }
+    for (auto const& version : *versions) {
+      std::cerr << version.first << ' ' << version.second << std::endl;
+    }
+  }
+}
+
+void print_startup_report(std::vector<startup_phase> const& phases, OutputFormat format) {
+  if(rank != 0) return;
+  switch(format) {
+    case OutputFormat::Human:
+      std::cerr << "startup timing:" << std::endl;
+      for (auto const& phase : phases) {
+        std::cerr << "  " << phase.name << ' ' << phase.ms << " ms" << std::endl;
+      }
+      break;
+    case OutputFormat::JSON:
+      std::cout << "{\"startup\":[";
+      for (size_t i = 0; i < phases.size(); ++i) {
+        std::cout << ((i == 0) ? "" : ",") << "{\"phase\":\"" << phases[i].name << "\",\"ms\":" << phases[i].ms << "}";
+      }
+      std::cout << "]}" << std::endl;
+      break;
   }
 }
 
+/**
+ * prints the options whose keys match a pattern in [begin, end); a label
+ * names which input the options belong to when there is one set per input
+ */
 template <class ForwardIt>
-void print_selected_options(pressio_options const& options, ForwardIt begin, ForwardIt end, OutputFormat format = OutputFormat::Human) {
+void print_selected_options(pressio_options const& options, ForwardIt begin, ForwardIt end, OutputFormat format = OutputFormat::Human, compat::optional<std::string> const& label = {}) {
   if(rank == 0) {
       std::vector<std::string> keys;
       std::set<std::string> matched_keys;
@@ -173,6 +232,9 @@ void print_selected_options(pressio_options const& options, ForwardIt begin, For
       }
   switch(format) {
     case OutputFormat::Human:
+      if(label && !matched_keys.empty()) {
+        std::cerr << "input " << *label << std::endl;
+      }
       std::for_each(
           matched_keys.begin(),
           matched_keys.end(),
@@ -181,7 +243,7 @@ void print_selected_options(pressio_options const& options, ForwardIt begin, For
                 std::cerr << key << options.get(key) << std::endl;
               } catch(std::out_of_range const&) {
                 std::cerr << ": option is unknown" << std::endl;
-                exit(EXIT_FAILURE);
+                tool_exit(EXIT_FAILURE);
               }
           });
         break;
@@ -193,13 +255,14 @@ void print_selected_options(pressio_options const& options, ForwardIt begin, For
               pressio_option const& value = options.get(key);
               for_json.set(key, value);
             }
+            if(label) for_json.set("input", *label);
           char* json = pressio_options_to_json(nullptr, &for_json);
           std::cout << json << std::endl;
           free(json);
         }
 #else
         std::cerr << "JSON support not included in libpressio" << std::endl;
-        exit(1);
+        tool_exit(1);
 #endif
         break;
       }
@@ -214,53 +277,79 @@ void set_early_options(PressioObject& c, std::multimap<std::string,std::string>
     if(rank == 0) {
       std::cerr << c.error_msg() << std::endl;
     }
-    exit(c.error_code());
+    tool_exit(c.error_code());
   }
   if (c.set_options(early_compressor_options)) {
     if(rank == 0) {
       std::cerr << c.error_msg() << std::endl;
     }
-    exit(c.error_code());
+    tool_exit(c.error_code());
   }
 }
 
-
-pressio_compressor setup_compressor(pressio& library, cmdline_options const& opts) {
+/**
+ * creates and configures the compressor for opts; index records the
+ * compressor's options so that it can be reconfigured later
+ */
+pressio_compressor setup_compressor(pressio& library, cmdline_options const& opts, option_index& index) {
   pressio_compressor compressor = library.get_compressor(opts.compressor);
   if (!compressor) {
     if(rank == 0) {
     std::cerr << "failed to initialize the compressor: " << opts.compressor << std::endl;
     std::cerr << library.err_msg() << std::endl;
     }
-    exit(library.err_code());
+    tool_exit(library.err_code());
   }
   if(opts.qualified_prefix) {
     compressor->set_name(*opts.qualified_prefix);
   }
   if(contains(opts.actions, Action::LoadConfig)) {
+    compat::optional<binary_config> config;
+    try {
+      config = load_binary_config(opts.config_file);
+    } catch(std::exception const& ex) {
+      std::cerr << "failed to load " << opts.config_file << ": " << ex.what() << std::endl;
+      tool_exit(1);
+    }
+    if(config) {
+      //the options were validated when they were saved, so only check them again if the plugins changed
+      const bool same_plugins = config->compressor_id == opts.compressor &&
+        config->compressor_version == compressor->version() &&
+        config->libpressio_version == pressio_version();
+      if(!same_plugins && compressor->check_options(config->options)) {
+          std::cerr << opts.config_file << " was saved with " << config->compressor_id << ' ' << config->compressor_version
+            << " and no longer validates: " << compressor->error_msg() << std::endl;
+          tool_exit(compressor->error_code());
+      }
+      if(compressor->set_options(config->options)) {
+          std::cerr << compressor->error_msg() << std::endl;
+          tool_exit(compressor->error_code());
+      }
+    } else {
 #if LIBPRESSIO_HAS_JSON
       std::ostringstream oss;
       std::ifstream in (opts.config_file);
       if(!in) {
           std::cerr << "failed to read file " << opts.config_file << std::endl;
-          exit(1);
+          tool_exit(1);
       }
       oss << in.rdbuf();
       std::string json_str(oss.str());
       pressio_options* opts = pressio_options_new_json(&library, json_str.c_str());
       if(!opts) {
           std::cerr << library.err_msg() << std::endl;
-          exit(library.err_code());
+          tool_exit(library.err_code());
       }
       if(compressor->set_options(*opts)) {
           std::cerr << compressor->error_msg() << std::endl;
-          exit(compressor->error_code());
+          tool_exit(compressor->error_code());
       }
       pressio_options_free(opts);
 #else
       std::cerr << "libpressio built without JSON support" << std::endl;
-      exit(1);
+      tool_exit(1);
 #endif
+    }
   }
 
   pressio_metrics metrics = library.get_metrics(std::begin(opts.metrics_ids), std::end(opts.metrics_ids));
@@ -272,7 +361,7 @@ pressio_compressor setup_compressor(pressio& library, cmdline_options const& opt
               std::ostream_iterator<const char*>(std::cerr, " "));
     std::cerr << library.err_msg() << std::endl;
     }
-    exit(library.err_code());
+    tool_exit(library.err_code());
   }
 
   compat::optional<pressio_options> null;
@@ -285,8 +374,28 @@ pressio_compressor setup_compressor(pressio& library, cmdline_options const& opt
   if(contains(opts.actions, Action::SaveConfig)) {
       out = options_from_multimap(opts.early_options);
   }
-  int rc = set_options_from_multimap(*compressor, opts.options, "compressor", out);
-  if(contains(opts.actions, Action::SaveConfig)) {
+  int rc = set_options_from_multimap(*compressor, opts.options, "compressor", out, index);
+  if(rc) {
+    if(rank == 0) {
+      std::cerr << compressor->error_msg() << std::endl;
+    }
+    tool_exit(compressor->error_code());
+  }
+  if(contains(opts.actions, Action::SaveConfig) && is_binary_config_path(opts.config_file)) {
+    //binary configs are not checked again when loaded with the same plugins, so only save valid ones
+    if(compressor->check_options(*out)) {
+      if(rank == 0) {
+        std::cerr << compressor->error_msg() << std::endl;
+      }
+      tool_exit(compressor->error_code());
+    }
+    try {
+      save_binary_config(opts.config_file, binary_config{opts.compressor, compressor->version(), pressio_version(), *out});
+    } catch(std::exception const& ex) {
+      std::cerr << ex.what() << std::endl;
+      tool_exit(1);
+    }
+  } else if(contains(opts.actions, Action::SaveConfig)) {
 #if LIBPRESSIO_HAS_JSON
           std::ofstream of(opts.config_file);
           char* str = pressio_options_to_json(&library, &*out);
@@ -294,22 +403,96 @@ pressio_compressor setup_compressor(pressio& library, cmdline_options const& opt
           free(str);
 #else
           std::cerr << "JSON support not included" << std::endl;
-          exit(1);
+          tool_exit(1);
 #endif
   }
-  if(rc) {
-    if(rank == 0) {
-      std::cerr << compressor->error_msg() << std::endl;
+
+  return compressor;
+}
+
+bool is_container_output(cmdline_options const& opts, size_t i) {
+  return i < opts.compressed_descriptions.size() && opts.compressed_descriptions[i].format == std::string("container");
+}
+
+container_header make_container_header(struct pressio_compressor& compressor, cmdline_options const& opts, pressio_data const& input, size_t block_extent) {
+  container_header header;
+  header.dtype = input.dtype();
+  header.dims = input.dimensions();
+  header.block_extent = block_extent;
+  header.compressor_id = opts.compressor;
+  header.compressor_options = options_to_string(compressor->get_options());
+  return header;
+}
+
+std::vector<pressio_data> compress_blocks(struct pressio_compressor& compressor, pressio_data const& input, size_t block_extent) {
+  std::vector<pressio_data> blocks;
+  std::vector<size_t> dims = input.dimensions();
+  const size_t slowest = dims.empty() ? 0 : dims.back();
+  const size_t slab_bytes = (slowest == 0) ? 0 : input.size_in_bytes() / slowest;
+  for (size_t start = 0; start < slowest; start += block_extent) {
+    dims.back() = std::min(block_extent, slowest - start);
+    pressio_data slab = pressio_data::nonowning(input.dtype(), static_cast<char*>(input.data()) + start * slab_bytes, dims);
+    pressio_data block = pressio_data::empty(pressio_byte_dtype, {});
+    if(compressor->compress(&slab, &block)) {
+      throw std::runtime_error(compressor->error_msg());
     }
-    exit(compressor->error_code());
+    blocks.emplace_back(std::move(block));
   }
+  return blocks;
+}
 
-  return compressor;
+/**
+ * compresses input as the i-th input on its own, packing it into a container if requested
+ */
+int compress_one(struct pressio_compressor& compressor, cmdline_options const& opts, size_t i, pressio_data const& input, pressio_data& compressed) {
+  if(!is_container_output(opts, i)) {
+    return compressor->compress(&input, &compressed);
+  }
+  if(opts.chunk_size) {
+    const size_t block_extent = std::max<size_t>(1, *opts.chunk_size);
+    auto header = make_container_header(compressor, opts, input, block_extent);
+    compressed = pack_container(header, compress_blocks(compressor, input, block_extent));
+    return 0;
+  }
+  if(int rc = compressor->compress(&input, &compressed)) {
+    return rc;
+  }
+  auto header = make_container_header(compressor, opts, input, std::max<size_t>(1, input.dimensions().empty() ? 0 : input.dimensions().back()));
+  compressed = pack_container(header, {compressed});
+  return 0;
 }
 
 std::vector<pressio_data> compress(struct pressio_compressor& compressor, cmdline_options const& opts) {
 
   std::vector<pressio_data> compressed(opts.num_compressed.value_or(opts.input.size()), pressio_data::empty(pressio_byte_dtype, 0, nullptr));
+  bool any_containers = false;
+  for (size_t i = 0; i < compressed.size(); ++i) {
+    any_containers |= is_container_output(opts, i);
+  }
+  if(any_containers && compressed.size() != opts.input.size()) {
+    if(rank == 0) {
+      std::cerr << "container outputs require one compressed buffer per input" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+
+  if(any_containers && opts.chunk_size) {
+    //blocked containers compress each block independently so they can be decoded independently
+    for (size_t i = 0; i < compressed.size(); ++i) {
+      try {
+        if(compress_one(compressor, opts, i, opts.input[i], compressed[i])) {
+          throw std::runtime_error(compressor->error_msg());
+        }
+      } catch(std::exception const& ex) {
+        if(rank == 0) {
+          std::cerr << ex.what() << std::endl;
+        }
+        tool_exit(EXIT_FAILURE);
+      }
+    }
+    return compressed;
+  }
+
   std::vector<const pressio_data*> inputs_ptrs(opts.input.size());
   std::vector<pressio_data*> compressed_ptrs(compressed.size());
   for (size_t i = 0; i < inputs_ptrs.size(); ++i) {
@@ -329,26 +512,328 @@ std::vector<pressio_data> compress(struct pressio_compressor& compressor, cmdlin
     if(rank == 0) {
       std::cerr << compressor->error_msg() << std::endl;
     }
-    exit(compressor->error_code());
+    tool_exit(compressor->error_code());
+  }
+
+  for (size_t i = 0; i < compressed.size(); ++i) {
+    if(is_container_output(opts, i)) {
+      auto const& input = opts.input[i];
+      auto header = make_container_header(compressor, opts, input, std::max<size_t>(1, input.dimensions().empty() ? 0 : input.dimensions().back()));
+      compressed[i] = pack_container(header, {compressed[i]});
+    }
   }
   return compressed;
 }
 
-std::vector<pressio_data> decompress(struct pressio_compressor& compressor, std::vector<pressio_data> const& compressed,  cmdline_options const& opts) {
-  std::vector<pressio_data> output_buffer;
-  std::vector<const pressio_data*> compressed_ptrs(compressed.size());
-  std::vector<pressio_data*> output_buffer_ptrs;
-  for (size_t i = 0; i < compressed.size(); ++i) {
-    compressed_ptrs[i] = &compressed[i];
+bool is_mapped_output(cmdline_options const& opts, size_t i) {
+  if(i >= opts.decompressed_descriptions.size()) return false;
+  auto const& desc = opts.decompressed_descriptions[i];
+  return desc.output_mode == OutputMode::Mmap || (desc.path && is_shared_memory_path(*desc.path));
+}
+
+/**
+ * writes the i-th compressed buffer through its io plugin, or publishes it to
+ * a shared memory segment for -w shm:<name>
+ */
+void write_compressed(cmdline_options& opts, size_t i, pressio_data const& compressed) {
+  auto const& path = opts.compressed_descriptions[i].path;
+  if(path && is_shared_memory_path(*path)) {
+    publish_to_shared_memory(*path, compressed);
+  } else if(pressio_io_write(&opts.compressed_file_action[i], &compressed)) {
+    throw std::runtime_error(std::string("writing compressed file failed ") + pressio_io_error_msg(&opts.compressed_file_action[i]));
+  }
+}
+
+/**
+ * allocates the buffer that the i-th decompressed output is decoded into; with
+ * -X mmap or -W shm:<name> this is the output itself so that no separate write
+ * is needed.  Every rank decodes the same outputs, so only rank 0 maps them.
+ */
+pressio_data make_decompressed_buffer(cmdline_options const& opts, size_t i, pressio_dtype dtype, std::vector<size_t> const& dims) {
+  if(!is_mapped_output(opts, i) || rank != 0) {
+    return pressio_data::owning(dtype, dims);
+  }
+  auto const& path = opts.decompressed_descriptions[i].path;
+  if(!path) {
+    throw std::runtime_error("-X mmap requires a decompressed file path (-W)");
+  }
+  return map_output_file(*path, dtype, dims);
+}
+
+void decompress_container(struct pressio_compressor& compressor, container_view const& container, pressio_data& output) {
+  auto const& header = container.header();
+  const size_t slowest = header.dims.empty() ? 0 : header.dims.back();
+  const size_t slab_bytes = (slowest == 0) ? 0 : output.size_in_bytes() / slowest;
+  for (size_t b = 0; b < container.num_blocks(); ++b) {
+    std::vector<size_t> dims = header.dims;
+    dims.back() = container.block_count(b);
+    char* ptr = static_cast<char*>(output.data()) + container.block_start(b) * slab_bytes;
+    pressio_data slab = pressio_data::nonowning(header.dtype, ptr, dims);
+    pressio_data block = container.block(b);
+    if(compressor->decompress(&block, &slab)) {
+      throw std::runtime_error(compressor->error_msg());
+    }
+    if(slab.data() != ptr) {
+      //some compressors replace the output buffer rather than filling it
+      std::memcpy(ptr, slab.data(), std::min(slab.size_in_bytes(), dims.back() * slab_bytes));
+    }
+  }
+}
+
+void decompress_container_region(struct pressio_compressor& compressor, container_view const& container, hyperslab const& region, pressio_data& output) {
+  auto const& header = container.header();
+  const size_t last = header.dims.size() - 1;
+  const size_t region_begin = region.start[last];
+  const size_t region_end = region_begin + region.count[last];
+  std::vector<size_t> scratch_dims = header.dims;
+  scratch_dims.back() = std::min<size_t>(header.block_extent, header.dims.back());
+  pressio_data scratch = pressio_data::owning(header.dtype, scratch_dims);
+
+  for (size_t b = 0; b < container.num_blocks(); ++b) {
+    const size_t block_begin = container.block_start(b);
+    const size_t begin = std::max(block_begin, region_begin);
+    const size_t end = std::min(block_begin + container.block_count(b), region_end);
+    if(begin >= end) continue;
+
+    std::vector<size_t> dims = header.dims;
+    dims.back() = container.block_count(b);
+    pressio_data slab = pressio_data::nonowning(header.dtype, scratch.data(), dims);
+    pressio_data block = container.block(b);
+    if(compressor->decompress(&block, &slab)) {
+      throw std::runtime_error(compressor->error_msg());
+    }
+
+    std::vector<size_t> src_start = region.start;
+    src_start[last] = begin - block_begin;
+    std::vector<size_t> dst_start(header.dims.size(), 0);
+    dst_start[last] = begin - region_begin;
+    std::vector<size_t> count = region.count;
+    count[last] = end - begin;
+    copy_hyperslab(slab.data(), dims, src_start, output.data(), region.count, dst_start, count, pressio_dtype_size(header.dtype));
+  }
+}
+
+void extract_region(pressio_data const& data, hyperslab const& region, pressio_data& output) {
+  copy_hyperslab(data.data(), data.dimensions(), region.start,
+      output.data(), region.count, std::vector<size_t>(region.count.size(), 0),
+      region.count, pressio_dtype_size(data.dtype()));
+}
+
+bool restores_recorded_options(cmdline_options const& opts) {
+  return !contains(opts.actions, Action::Compress);
+}
+
+/**
+ * set once a request restores recorded options, which reconfigures its
+ * compressor beyond what the request's own options describe
+ */
+std::atomic<bool> recorded_options_restored{false};
+
+/**
+ * in decompress-only mode, restores the configuration recorded in the
+ * container at compression time and then reapplies the user's overrides.
+ *
+ * index tracks the options of compressor so that inputs recorded with the same
+ * configuration do not reconfigure it again
+ */
+void restore_recorded_options(struct pressio_compressor& compressor, container_view const& container, cmdline_options const& opts, option_index& index) {
+  if(!restores_recorded_options(opts)) return;
+  auto recorded = options_from_string(container.header().compressor_options);
+  if(!recorded) return;
+  recorded_options_restored = true;
+  if(!index.indexed()) {
+    //the recorded options may change which options exist, so index after applying them
+    if(compressor->set_options(*recorded)) {
+      throw std::runtime_error(compressor->error_msg());
+    }
+    index = option_index(compressor->get_options());
+    //the overrides are set even if they match what the recorded options reported
+    if(apply_options(*compressor, resolve_options_from_multimap(index, opts.options, "compressor"), index)) {
+      throw std::runtime_error(compressor->error_msg());
+    }
+    return;
+  }
+  pressio_options desired = std::move(*recorded);
+  desired.copy_from(resolve_options_from_multimap(index, opts.options, "compressor"));
+  if(apply_changed_options(*compressor, desired, index)) {
+    throw std::runtime_error(compressor->error_msg());
+  }
+}
+
+/**
+ * decodes a container input into output after restoring its recorded options
+ */
+void decompress_container_input(struct pressio_compressor& compressor, pressio_data const& compressed, cmdline_options const& opts, size_t i, pressio_data& output, option_index& index) {
+  try {
+    container_view container(compressed);
+    restore_recorded_options(compressor, container, opts, index);
+    auto const& header = container.header();
+    if(opts.region) {
+      auto region = resolve_hyperslab(*opts.region, header.dims);
+      output = make_decompressed_buffer(opts, i, header.dtype, region.count);
+      decompress_container_region(compressor, container, region, output);
+    } else {
+      output = make_decompressed_buffer(opts, i, header.dtype, header.dims);
+      decompress_container(compressor, container, output);
+    }
+  } catch(std::exception const& ex) {
+    throw std::runtime_error(std::string("failed to decode container: ") + ex.what());
+  }
+}
+
+/**
+ * allocates the output of a non-container input; mapped outputs are returned
+ * as a view of the mapping which is held in mapped
+ */
+pressio_data make_raw_output(cmdline_options const& opts, size_t i, pressio_data const& input, pressio_data& mapped) {
+  if(is_mapped_output(opts, i) && !opts.region) {
+    try {
+      mapped = make_decompressed_buffer(opts, i, input.dtype(), input.dimensions());
+    } catch(std::exception const& ex) {
+      throw std::runtime_error(std::string("failed to map decompressed file: ") + ex.what());
+    }
+    return pressio_data::nonowning(mapped.dtype(), mapped.data(), mapped.dimensions());
   }
-  for (auto const& input : opts.input) {
-    output_buffer.emplace_back(pressio_data::clone(input));
+  return pressio_data::clone(input);
+}
+
+/**
+ * moves a decoded non-container output into its mapping if it has one and
+ * crops it to the -R region if one was requested
+ */
+void finish_raw_output(cmdline_options const& opts, size_t i, pressio_data& output, pressio_data& mapped) {
+  if(mapped.has_data()) {
+    //some compressors replace the output buffer rather than filling it
+    if(output.data() != mapped.data()) {
+      std::memcpy(mapped.data(), output.data(), std::min(mapped.size_in_bytes(), output.size_in_bytes()));
+    }
+    output = std::move(mapped);
   }
-  for (auto& output: output_buffer) {
-    output_buffer_ptrs.emplace_back(&output);
+  if(opts.region) {
+    //inputs without a block index have to be decoded in full before selecting the region
+    try {
+      auto region = resolve_hyperslab(*opts.region, output.dimensions());
+      pressio_data cropped = make_decompressed_buffer(opts, i, output.dtype(), region.count);
+      extract_region(output, region, cropped);
+      output = std::move(cropped);
+    } catch(std::exception const& ex) {
+      throw std::runtime_error(std::string("invalid region: ") + ex.what());
+    }
   }
+}
+
+#if LIBPRESSIO_TOOLS_HAS_MPI
+[[noreturn]] void abort_partitioned(std::string const& msg) {
+  std::cerr << msg << std::endl;
+  MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  tool_exit(EXIT_FAILURE);
+}
+
+/**
+ * -P: every rank compresses its slab of each input and the slabs are written
+ * collectively as the blocks of one container; decompression writes each
+ * rank's decoded slabs at their offsets in one raw output
+ */
+void run_partitioned(struct pressio_compressor& compressor, cmdline_options const& opts) {
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  auto slab_bytes_of = [](pressio_dtype dtype, std::vector<size_t> const& dims) {
+    return std::accumulate(dims.begin(), dims.end() - 1, pressio_dtype_size(dtype), std::multiplies<>{});
+  };
 
-  if (compressor->decompress_many(
+  option_index index;
+  for (size_t i = 0; i < opts.input.size(); ++i) {
+    auto const& compressed_path = opts.compressed_descriptions.at(i).path;
+    auto const& decompressed_path = opts.decompressed_descriptions.at(i).path;
+    std::vector<std::pair<uint64_t, pressio_data>> pieces;
+    std::vector<size_t> global_dims;
+    pressio_dtype dtype;
+
+    try {
+      if(contains(opts.actions, Action::Compress)) {
+        auto const& global = opts.partitions.at(i);
+        auto const& local = opts.input[i];
+        const hyperslab slab = partition_hyperslab(global, rank, size);
+        global_dims = global.count;
+        dtype = local.dtype();
+
+        pressio_data compressed = pressio_data::empty(pressio_byte_dtype, {});
+        if(local.num_elements() > 0 && compressor->compress(&local, &compressed)) {
+          abort_partitioned(compressor->error_msg());
+        }
+        if(compressed_path) {
+          auto header = make_container_header(compressor, opts, local, std::max<size_t>(1, partition_extent(global.count.back(), size)));
+          header.dims = global.count;
+          write_partitioned_container(*compressed_path, header, compressed, MPI_COMM_WORLD);
+        }
+        if(contains(opts.actions, Action::Decompress) && local.num_elements() > 0) {
+          pressio_data decompressed = pressio_data::owning(local.dtype(), local.dimensions());
+          if(compressor->decompress(&compressed, &decompressed)) {
+            abort_partitioned(compressor->error_msg());
+          }
+          pieces.emplace_back((slab.start.back() - global.start.back()) * slab_bytes_of(dtype, global_dims), std::move(decompressed));
+        }
+      } else {
+        //blocks are dealt out round-robin so containers with any number of blocks decode in parallel
+        container_view container(opts.input[i]);
+        restore_recorded_options(compressor, container, opts, index);
+        auto const& header = container.header();
+        global_dims = header.dims;
+        dtype = header.dtype;
+        for (size_t b = rank; b < container.num_blocks(); b += size) {
+          std::vector<size_t> dims = header.dims;
+          dims.back() = container.block_count(b);
+          pressio_data block = container.block(b);
+          pressio_data decompressed = pressio_data::owning(header.dtype, dims);
+          if(compressor->decompress(&block, &decompressed)) {
+            abort_partitioned(compressor->error_msg());
+          }
+          pieces.emplace_back(container.block_start(b) * slab_bytes_of(dtype, global_dims), std::move(decompressed));
+        }
+      }
+
+      if(contains(opts.actions, Action::Decompress) && decompressed_path && !global_dims.empty()) {
+        write_partitioned_raw(*decompressed_path, pieces, slab_bytes_of(dtype, global_dims) * global_dims.back(), MPI_COMM_WORLD);
+      }
+    } catch(std::exception const& ex) {
+      abort_partitioned(std::string("partitioned run failed: ") + ex.what());
+    }
+  }
+}
+#endif
+
+std::vector<pressio_data> decompress(struct pressio_compressor& compressor, std::vector<pressio_data> const& compressed,  cmdline_options const& opts) {
+  std::vector<pressio_data> output_buffer(opts.input.size());
+  std::vector<pressio_data> mapped(opts.input.size());
+  auto is_container_input = [&](size_t i) {
+    return i < compressed.size() && is_container(compressed[i]);
+  };
+
+  std::vector<const pressio_data*> compressed_ptrs;
+  std::vector<pressio_data*> output_buffer_ptrs;
+  option_index index;
+  try {
+    for (size_t i = 0; i < compressed.size(); ++i) {
+      if(!is_container_input(i)) {
+        compressed_ptrs.emplace_back(&compressed[i]);
+        continue;
+      }
+      if(i >= output_buffer.size()) output_buffer.resize(i + 1);
+      decompress_container_input(compressor, compressed[i], opts, i, output_buffer[i], index);
+    }
+    for (size_t i = 0; i < opts.input.size(); ++i) {
+      if(is_container_input(i)) continue;
+      output_buffer[i] = make_raw_output(opts, i, opts.input[i], mapped[i]);
+      output_buffer_ptrs.emplace_back(&output_buffer[i]);
+    }
+  } catch(std::exception const& ex) {
+    if(rank == 0) {
+      std::cerr << ex.what() << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+
+  if (!compressed_ptrs.empty() && compressor->decompress_many(
         compat::data(compressed_ptrs),
         compat::data(compressed_ptrs) + compat::size(compressed_ptrs),
         output_buffer_ptrs.data(),
@@ -357,101 +842,579 @@ std::vector<pressio_data> decompress(struct pressio_compressor& compressor, std:
     if(rank == 0) {
       std::cerr << compressor->error_msg() << std::endl;
     }
-    exit(compressor->error_code());
+    tool_exit(compressor->error_code());
+  }
+  try {
+    for (size_t i = 0; i < opts.input.size(); ++i) {
+      if(is_container_input(i)) continue;
+      finish_raw_output(opts, i, output_buffer[i], mapped[i]);
+    }
+  } catch(std::exception const& ex) {
+    if(rank == 0) {
+      std::cerr << ex.what() << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
   }
   return output_buffer;
 }
 
-int
-main(int argc, char* argv[])
-{
-  libpressio_register_all();
-  #if LIBPRESSIO_TOOLS_HAS_MPI
-  int requested=MPI_THREAD_MULTIPLE, provided;
-  MPI_Init_thread(&argc, &argv, requested, &provided);
-  #endif
-  {
-    #if LIBPRESSIO_TOOLS_HAS_MPI
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    #else
-    rank = 0;
-    #endif
-    auto opts = parse_args(argc, argv);
-    pressio library;
+/**
+ * true if -J processes the inputs concurrently
+ */
+bool runs_concurrently(cmdline_options const& opts) {
+  return opts.threads > 1 && contains_one_of(opts.actions, {Action::Compress, Action::Decompress}) &&
+    (!contains(opts.actions, Action::Compress) || opts.num_compressed.value_or(opts.input.size()) == opts.input.size());
+}
 
-    if(opts.actions.find(Action::Version) != opts.actions.end()) {
-      print_versions(library);
-    }
+/**
+ * -J: compresses and/or decompresses the inputs concurrently.  Each input is
+ * compressed and decompressed by the same worker and its metrics are taken
+ * right after, so the results returned per input describe that input alone.
+ */
+std::vector<pressio_options> run_concurrently(struct pressio_compressor& compressor, cmdline_options const& opts, std::vector<pressio_data>& compressed, std::vector<pressio_data>& decompressed) {
+  const bool compressing = contains(opts.actions, Action::Compress);
+  const bool decompressing = contains(opts.actions, Action::Decompress);
+  const size_t num_inputs = opts.input.size();
+  for (size_t i = 0; i < num_inputs; ++i) {
+    if(compressing) compressed.emplace_back(pressio_data::empty(pressio_byte_dtype, {}));
+    else compressed.emplace_back(pressio_data::nonowning(opts.input[i].dtype(), opts.input[i].data(), opts.input[i].dimensions()));
+  }
+  if(decompressing) decompressed.resize(num_inputs);
+  std::vector<pressio_data> mapped(num_inputs);
+  std::vector<pressio_options> metrics(num_inputs);
 
-    if (contains_one_of(opts.actions, {Action::Compress, Action::Decompress, Action::Settings, Action::Help, Action::Graph, Action::SaveConfig, Action::LoadConfig, Action::FullHelp})) {
+  //restoring recorded options reconfigures the compressor and metrics plugins keep
+  //per-call state, so either one requires each worker to have its own instance
+  const bool any_containers = std::any_of(compressed.begin(), compressed.end(), [](pressio_data const& c) { return is_container(c); });
+  const bool private_instances = !opts.metrics_ids.empty() || !opts.print_metrics.empty() || (decompressing && any_containers && restores_recorded_options(opts));
+  std::mutex indexes_mutex;
+  std::map<pressio_compressor const*, option_index> indexes;
+  auto index_of = [&](pressio_compressor const& worker) -> option_index& {
+    std::lock_guard<std::mutex> guard(indexes_mutex);
+    return indexes[&worker];
+  };
+  parallel_for_each(compressor, opts.threads, num_inputs, [&](pressio_compressor& worker, size_t i) {
+      if(compressing) {
+        if(int rc = compress_one(worker, opts, i, opts.input[i], compressed[i])) return rc;
+      }
+      if(decompressing) {
+        if(is_container(compressed[i])) {
+          decompress_container_input(worker, compressed[i], opts, i, decompressed[i], index_of(worker));
+        } else {
+          decompressed[i] = make_raw_output(opts, i, opts.input[i], mapped[i]);
+          if(int rc = worker->decompress(&compressed[i], &decompressed[i])) return rc;
+          finish_raw_output(opts, i, decompressed[i], mapped[i]);
+        }
+      }
+      metrics[i] = worker->get_metrics_results();
+      return 0;
+    }, private_instances);
+  return metrics;
+}
 
-      auto compressor = setup_compressor(library, opts);
-      auto options = compressor->get_options();
-      auto metrics = compressor->get_metrics();
-      std::vector<pressio_data> compressed;
-      std::vector<pressio_data> decompressed;
+/**
+ * reads the input described by desc through io
+ */
+pressio_data read_input(cmdline_options const& opts, io_description const& desc, pressio_io io) {
+  if(!contains_one_of(opts.actions, {Action::Compress, Action::Watch}) && desc.path && is_container_file(*desc.path)) {
+    return (desc.mapped)
+      ? map_input_file(*desc.path, compat::nullopt, {}, *desc.mapped)
+      : load_container_file(*desc.path);
+  }
+  if(desc.mapped) {
+    if(!desc.path || !desc.selection.empty()) {
+      throw std::runtime_error("-L mmap requires a raw binary input from -i without -x");
+    }
+    return map_input_file(*desc.path, desc.dtype, desc.dims, *desc.mapped);
+  }
+  if(!desc.selection.empty()) {
+    auto reader = make_hyperslab_reader(io, desc);
+    return reader->read(resolve_selection(desc));
+  }
+  auto input_desc = (desc.dtype)
+    ? std::make_unique<pressio_data>(pressio_data::owning(*desc.dtype, desc.dims))
+    : std::unique_ptr<pressio_data>(nullptr);
+  std::unique_ptr<pressio_data> data(io->read(input_desc.get()));
+  if(!data) {
+    throw std::runtime_error(std::string("failed to read input file ") + io->error_msg());
+  }
+  return std::move(*data);
+}
 
-      if (contains(opts.actions, Action::FullHelp)) {
-        print_help(compressor, Action::FullHelp);
-      } else if (contains(opts.actions, Action::Help)) {
-        print_help(compressor, Action::Help);
-      }
+/**
+ * reads input i for -q, where inputs are read by the pipeline rather than
+ * up front by parse_args
+ */
+pressio_data read_input(cmdline_options const& opts, size_t i) {
+  return read_input(opts, opts.input_descriptions[i], opts.input_file_action[i]);
+}
 
-      if (contains(opts.actions, Action::Settings)) {
-        print_selected_options(options, std::begin(opts.print_options), std::end(opts.print_options), opts.format);
-        print_selected_options(compressor->get_configuration(), std::begin(opts.print_compile_options), std::end(opts.print_compile_options), opts.format);
-        print_selected_options(metrics->get_options(), std::begin(opts.print_metrics_options), std::end(opts.print_metrics_options), opts.format);
+struct input_result {
+  pressio_data compressed;
+  pressio_data decompressed;
+  pressio_options metrics;
+};
 
-        for (const auto& input_file_action : opts.input_file_action) {
-          print_selected_options(input_file_action->get_options(), std::begin(opts.print_io_input_options), std::end(opts.print_io_input_options), opts.format);
-        }
-        for (auto const& compressed_file_action : opts.compressed_file_action) {
-          print_selected_options(compressed_file_action->get_options(), std::begin(opts.print_io_comp_options), std::end(opts.print_io_comp_options), opts.format);
-        }
-        for (auto const& decompressed_file_action : opts.decompressed_file_action) {
-          print_selected_options(decompressed_file_action->get_options(), std::begin(opts.print_io_decomp_options), std::end(opts.print_io_decomp_options), opts.format);
+/**
+ * processes each input end to end instead of holding every input, compressed
+ * buffer, and decompressed buffer at once.  With -q, input i+1 is read while
+ * input i is compressed and decompressed and input i-1 is written; with -H the
+ * stages run one after another so only one input is resident at a time.
+ *
+ * returns the metrics results of each input since metrics plugins only
+ * describe the most recent call
+ */
+std::vector<pressio_options> run_per_input(struct pressio_compressor& compressor, cmdline_options& opts) {
+  const bool compressing = contains(opts.actions, Action::Compress);
+  const bool decompressing = contains(opts.actions, Action::Decompress);
+  const size_t num_inputs = opts.input_descriptions.size();
+  if(opts.num_compressed && *opts.num_compressed != num_inputs) {
+    if(rank == 0) {
+      std::cerr << "-q and -H require one compressed buffer per input" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+
+  auto read = [&](size_t i) {
+    return read_input(opts, i);
+  };
+  option_index index;
+  auto process = [&](size_t i, pressio_data input) {
+    input_result result;
+    if(compressing) {
+      result.compressed = pressio_data::empty(pressio_byte_dtype, {});
+      if(compress_one(compressor, opts, i, input, result.compressed)) {
+        throw std::runtime_error(compressor->error_msg());
+      }
+    } else {
+      result.compressed = std::move(input);
+    }
+    if(decompressing) {
+      if(is_container(result.compressed)) {
+        decompress_container_input(compressor, result.compressed, opts, i, result.decompressed, index);
+      } else {
+        pressio_data mapped;
+        result.decompressed = make_raw_output(opts, i, compressing ? input : result.compressed, mapped);
+        if(compressor->decompress(&result.compressed, &result.decompressed)) {
+          throw std::runtime_error(compressor->error_msg());
         }
+        finish_raw_output(opts, i, result.decompressed, mapped);
       }
+    }
+    result.metrics = compressor->get_metrics_results();
+    return result;
+  };
+  std::vector<pressio_options> metrics(num_inputs);
+  auto write = [&](size_t i, input_result result) {
+    if(compressing) {
+      write_compressed(opts, i, result.compressed);
+    }
+    if(decompressing && !is_mapped_output(opts, i) && pressio_io_write(&opts.decompressed_file_action[i], &result.decompressed)) {
+      throw std::runtime_error(std::string("writing decompressed file failed ") + pressio_io_error_msg(&opts.decompressed_file_action[i]));
+    }
+    metrics[i] = std::move(result.metrics);
+  };
 
-      if (contains(opts.actions, Action::Graph)) {
-          print_graph(compressor, opts.graph_format);
+  try {
+    if(opts.pipeline_depth) {
+      run_pipeline(num_inputs, *opts.pipeline_depth, read, process, write);
+    } else {
+      for (size_t i = 0; i < num_inputs; ++i) {
+        write(i, process(i, read(i)));
       }
-      
-      if (contains(opts.actions, Action::Compress)) {
-        compressed = compress(compressor, opts);
+    }
+  } catch(std::exception const& ex) {
+    if(rank == 0) {
+      std::cerr << ex.what() << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+  return metrics;
+}
 
-        for (size_t i = 0; i < compressed.size(); ++i ) {
-          if (auto result = pressio_io_write(&opts.compressed_file_action[i], &compressed[i])) {
-            if(rank == 0) {
-              std::cerr << "writing compressed file failed " << pressio_io_error_msg(&opts.compressed_file_action[i]) << std::endl;
-            }
-            exit(EXIT_FAILURE);
-          }
-        }
+const std::string watch_suffix = ".pressio";
+
+/**
+ * where watch writes the compressed form of path: next to it, or into the -w directory
+ */
+std::string watch_output_path(cmdline_options const& opts, std::string const& path) {
+  auto const& directory = opts.compressed_descriptions.front().path;
+  if(!directory) return path + watch_suffix;
+  return *directory + '/' + path.substr(path.rfind('/') + 1) + watch_suffix;
+}
+
+/**
+ * writes compressed through a copy of writer to a hidden file next to path and
+ * renames it into place so that anything watching the output directory only
+ * sees complete files
+ */
+void write_watched(pressio_io const& writer, std::string const& path, pressio_data const& compressed) {
+  const size_t slash = path.rfind('/');
+  const std::string partial = path.substr(0, slash + 1) + '.' + path.substr(slash + 1) + ".part";
+  pressio_io io = writer;
+  io->set_options({
+      {"io:path", partial}
+  });
+  if(io->write(&compressed)) {
+    throw std::runtime_error(std::string("writing compressed file failed ") + io->error_msg());
+  }
+  if(std::rename(partial.c_str(), path.c_str())) {
+    throw std::runtime_error("failed to rename " + partial + " to " + path + ": " + std::strerror(errno));
+  }
+}
 
-      } else if (contains(opts.actions, Action::Decompress)) {
-        for (auto const& i: opts.input) {
-          compressed.emplace_back(pressio_data::nonowning(i.dtype(), i.data(), i.dimensions()));
+/**
+ * pressio -a watch: compresses each file matching -i <directory>/<pattern> as
+ * it lands using the one compressor that was set up, or a clone of it per
+ * thread if it is not thread safe
+ */
+void watch_inputs(pressio& library, struct pressio_compressor& compressor, cmdline_options const& opts) {
+#if LIBPRESSIO_TOOLS_HAS_MPI
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  if(size > 1) {
+    if(rank == 0) {
+      std::cerr << "watch does not support more than one MPI rank" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+#endif
+  auto const& pattern_path = opts.input_descriptions.front().path;
+  if(opts.input_descriptions.size() != 1 || !pattern_path || is_shared_memory_path(*pattern_path)) {
+    std::cerr << "watch requires one -i <directory>/<pattern>" << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+  auto const& output = opts.compressed_descriptions.front().path;
+  if(opts.compressed_descriptions.size() != 1 || (output && is_shared_memory_path(*output))) {
+    std::cerr << "watch writes into the directory given by -w" << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+  //the compressed io is noop without -w, so outputs are always written as raw bytes; containers are packed before writing
+  auto const& format = opts.compressed_descriptions.front().format;
+  if(format && *format != "posix" && *format != "container") {
+    std::cerr << "watch writes raw compressed files, -f must be posix or container" << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+  pressio_io writer = library.get_io("posix");
+  if(!writer) {
+    std::cerr << "failed to get io module posix" << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+  const size_t slash = pattern_path->rfind('/');
+  const std::string directory = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : pattern_path->substr(0, slash);
+  const std::string pattern = pattern_path->substr(slash + 1);
+
+  const size_t workers = std::max<size_t>(1, opts.threads);
+  std::vector<pressio_compressor> clones;
+  if(!is_thread_safe(compressor)) {
+    for (size_t w = 1; w < workers; ++w) {
+      clones.emplace_back(compressor->clone());
+    }
+  }
+
+  try {
+    watch_directory(directory, pattern, workers, opts.pipeline_depth.value_or(workers), [&](size_t w, std::string const& path) {
+        //outputs written next to their inputs land in the watched directory too
+        if(path.size() >= watch_suffix.size() && path.compare(path.size() - watch_suffix.size(), watch_suffix.size(), watch_suffix) == 0) return;
+        pressio_compressor& worker = (w == 0 || clones.empty()) ? compressor : clones[w - 1];
+        io_description desc = opts.input_descriptions.front();
+        desc.path = path;
+        pressio_io io = opts.input_file_action.front();
+        io->set_options({
+            {"io:path", path}
+        });
+        pressio_data input = read_input(opts, desc, io);
+        pressio_data compressed = pressio_data::empty(pressio_byte_dtype, {});
+        if(compress_one(worker, opts, 0, input, compressed)) {
+          throw std::runtime_error(worker->error_msg());
         }
+        write_watched(writer, watch_output_path(opts, path), compressed);
+      });
+  } catch(std::exception const& ex) {
+    std::cerr << "watch failed: " << ex.what() << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+}
+
+struct warm_compressor {
+  pressio_compressor compressor;
+  option_index index;
+};
+
+/**
+ * compressors configured by earlier requests of a pressio serve session,
+ * keyed by compressor_key
+ */
+std::map<std::string, warm_compressor> warm_compressors;
+
+/**
+ * the key of the warm compressor lent to the current request, if any
+ */
+compat::optional<std::string> borrowed_key;
+
+/**
+ * true while pressio serve runs requests
+ */
+bool caching_compressors = false;
+
+bool is_cacheable(cmdline_options const& opts) {
+  return !contains_one_of(opts.actions, {Action::SaveConfig, Action::LoadConfig});
+}
+
+std::string compressor_key(cmdline_options const& opts) {
+  std::ostringstream key;
+  key << opts.compressor << '\0' << opts.qualified_prefix.value_or("") << '\0';
+  for (auto const& option : opts.early_options) key << option.first << '=' << option.second << '\0';
+  key << '\0';
+  //only the names of the options; their values are reapplied when the compressor is reused
+  for (auto const& option : opts.options) key << option.first << '\0';
+  key << '\0';
+  for (auto const& id : opts.metrics_ids) key << id << '\0';
+  key << '\0';
+  for (auto const& option : opts.metrics_options) key << option.first << '=' << option.second << '\0';
+  return key.str();
+}
+
+bool needs_compressor(cmdline_options const& opts) {
+  return contains_one_of(opts.actions, {Action::Compress, Action::Decompress, Action::Settings, Action::Help, Action::Graph, Action::SaveConfig, Action::LoadConfig, Action::FullHelp, Action::StreamCompress, Action::Bench, Action::ProfileGraph, Action::Watch});
+}
+
+/**
+ * the compressor for opts.
+ *
+ * while serving, the compressor stays in warm_compressors for later requests
+ * and an existing one is reconfigured with only the options that changed;
+ * otherwise a new compressor is set up in owned
+ */
+pressio_compressor& borrow_compressor(pressio& library, cmdline_options const& opts, pressio_compressor& owned) {
+  if(!caching_compressors || !is_cacheable(opts)) {
+    option_index index;
+    owned = setup_compressor(library, opts, index);
+    return owned;
+  }
+  borrowed_key = compressor_key(opts);
+  auto it = warm_compressors.find(*borrowed_key);
+  if(it == warm_compressors.end()) {
+    warm_compressor warm;
+    warm.compressor = setup_compressor(library, opts, warm.index);
+    return warm_compressors.emplace(*borrowed_key, std::move(warm)).first->second.compressor;
+  }
+  warm_compressor& warm = it->second;
+  if(apply_changed_options(*warm.compressor, resolve_options_from_multimap(warm.index, opts.options, "compressor"), warm.index)) {
+    std::cerr << warm.compressor->error_msg() << std::endl;
+    tool_exit(warm.compressor->error_code());
+  }
+  return warm.compressor;
+}
+
+void run(pressio& library, cmdline_options& opts) {
+  if(opts.actions.find(Action::Version) != opts.actions.end()) {
+    print_versions(library, opts);
+  }
+
+  if (needs_compressor(opts)) {
+
+    compat::optional<phase_timer> setup_timer;
+    setup_timer.emplace(opts.startup_phases, "setup compressor");
+    pressio_compressor owned;
+    pressio_compressor& compressor = borrow_compressor(library, opts, owned);
+    setup_timer.reset();
+    auto options = compressor->get_options();
+    auto metrics = compressor->get_metrics();
+    std::vector<pressio_data> compressed;
+    std::vector<pressio_data> decompressed;
+
+    if (contains(opts.actions, Action::FullHelp)) {
+      print_help(compressor, Action::FullHelp);
+    } else if (contains(opts.actions, Action::Help)) {
+      print_help(compressor, Action::Help);
+    }
+
+    if (contains(opts.actions, Action::Settings)) {
+      print_selected_options(options, std::begin(opts.print_options), std::end(opts.print_options), opts.format);
+      print_selected_options(compressor->get_configuration(), std::begin(opts.print_compile_options), std::end(opts.print_compile_options), opts.format);
+      print_selected_options(metrics->get_options(), std::begin(opts.print_metrics_options), std::end(opts.print_metrics_options), opts.format);
+
+      for (const auto& input_file_action : opts.input_file_action) {
+        print_selected_options(input_file_action->get_options(), std::begin(opts.print_io_input_options), std::end(opts.print_io_input_options), opts.format);
+      }
+      for (auto const& compressed_file_action : opts.compressed_file_action) {
+        print_selected_options(compressed_file_action->get_options(), std::begin(opts.print_io_comp_options), std::end(opts.print_io_comp_options), opts.format);
       }
+      for (auto const& decompressed_file_action : opts.decompressed_file_action) {
+        print_selected_options(decompressed_file_action->get_options(), std::begin(opts.print_io_decomp_options), std::end(opts.print_io_decomp_options), opts.format);
+      }
+    }
 
-      if (contains(opts.actions, Action::Decompress)) {
+    if (contains(opts.actions, Action::Graph)) {
+        print_graph(compressor, opts.graph_format, opts.graph_verbose);
+    }
+
+    if (contains(opts.actions, Action::ProfileGraph)) {
+      auto profile = profile_compressor(compressor, opts);
+      if(rank == 0) {
+        if(opts.graph_format == "folded") print_folded(profile, std::cout);
+        else print_graph(compressor, opts.graph_format, opts.graph_verbose, &profile);
+      }
+    }
+
+    if (contains(opts.actions, Action::StreamCompress)) {
+      stream_compress(compressor, opts);
+    }
+
+    if (contains(opts.actions, Action::Bench)) {
+      bench(compressor, opts);
+    }
+
+    if (contains(opts.actions, Action::Watch)) {
+      watch_inputs(library, compressor, opts);
+    }
+    
+    std::vector<pressio_options> input_metrics;
+    if (processes_per_input(opts) && contains_one_of(opts.actions, {Action::Compress, Action::Decompress})) {
+      input_metrics = run_per_input(compressor, opts);
+    } else
 #if LIBPRESSIO_TOOLS_HAS_MPI
-        distributed::comm::bcast(compressed, 0, MPI_COMM_WORLD);
+    if (opts.partitioned) {
+      run_partitioned(compressor, opts);
+    } else
 #endif
-        decompressed = decompress(compressor, compressed, opts);
+    if (runs_concurrently(opts)) {
+      input_metrics = run_concurrently(compressor, opts, compressed, decompressed);
+    } else if (contains(opts.actions, Action::Compress)) {
+      compressed = compress(compressor, opts);
+    } else if (contains(opts.actions, Action::Decompress)) {
+      for (auto const& i: opts.input) {
+        compressed.emplace_back(pressio_data::nonowning(i.dtype(), i.data(), i.dimensions()));
       }
-      for (size_t i = 0; i < decompressed.size(); ++i) {
-        if (auto result = pressio_io_write(&opts.decompressed_file_action[i], &decompressed[i])) {
+    }
+
+    if (contains(opts.actions, Action::Compress)) {
+      for (size_t i = 0; i < compressed.size(); ++i ) {
+        try {
+          write_compressed(opts, i, compressed[i]);
+        } catch(std::exception const& ex) {
           if(rank == 0) {
-            std::cerr << "writing decompressed file failed " << pressio_io_error_msg(&opts.decompressed_file_action[i]) << std::endl;
+            std::cerr << ex.what() << std::endl;
           }
-          exit(EXIT_FAILURE);
+          tool_exit(EXIT_FAILURE);
+        }
+      }
+    }
+
+    if (!opts.partitioned && !processes_per_input(opts) && !runs_concurrently(opts) && contains(opts.actions, Action::Decompress)) {
+#if LIBPRESSIO_TOOLS_HAS_MPI
+      distributed::comm::bcast(compressed, 0, MPI_COMM_WORLD);
+#endif
+      decompressed = decompress(compressor, compressed, opts);
+    }
+    for (size_t i = 0; i < decompressed.size(); ++i) {
+      if (is_mapped_output(opts, i)) continue; //already decoded into the file
+      if (auto result = pressio_io_write(&opts.decompressed_file_action[i], &decompressed[i])) {
+        if(rank == 0) {
+          std::cerr << "writing decompressed file failed " << pressio_io_error_msg(&opts.decompressed_file_action[i]) << std::endl;
         }
+        tool_exit(EXIT_FAILURE);
       }
+    }
 
+    if (input_metrics.empty()) {
       print_selected_options(compressor->get_metrics_results(), std::begin(opts.print_metrics), std::end(opts.print_metrics), opts.format);
     }
+    for (size_t i = 0; i < input_metrics.size(); ++i) {
+      const bool has_path = i < opts.input_descriptions.size() && opts.input_descriptions[i].path;
+      print_selected_options(input_metrics[i], std::begin(opts.print_metrics), std::end(opts.print_metrics), opts.format,
+          has_path ? *opts.input_descriptions[i].path : std::to_string(i));
+    }
+  }
+
+  if (opts.startup_timing) {
+    print_startup_report(opts.startup_phases, opts.format);
+  }
+}
+
+std::vector<char*> make_argv(std::vector<std::string> const& args) {
+  std::vector<char*> argv;
+  for (auto const& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  return argv;
+}
+
+/**
+ * pressio serve: keeps the registered plugins, opened -D libraries, and the
+ * compressors of successful requests warm across requests
+ */
+void serve_requests(pressio& library, cmdline_options const& opts) {
+#if LIBPRESSIO_TOOLS_HAS_MPI
+  int size;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  if(size > 1) {
+    if(rank == 0) {
+      std::cerr << "serve does not support more than one MPI rank" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+#endif
+  caching_compressors = true;
+  try {
+    serve(opts.serve_address.value_or("-"),
+        [&library](std::vector<std::string> const& args) {
+          borrowed_key.reset();
+          recorded_options_restored = false;
+          auto argv = make_argv(args);
+          auto request = parse_args(static_cast<int>(args.size()), argv.data());
+          try {
+            run(library, request);
+          } catch(...) {
+            //a failed request may leave the compressor it borrowed half configured
+            if(borrowed_key) warm_compressors.erase(*borrowed_key);
+            throw;
+          }
+          return 0;
+        },
+        [] {
+          //options restored from a container are not part of the compressor's key
+          if(borrowed_key && recorded_options_restored) warm_compressors.erase(*borrowed_key);
+        });
+  } catch(std::exception const& ex) {
+    std::cerr << "serve failed: " << ex.what() << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<startup_phase> registration;
+  {
+    phase_timer timer(registration, "libpressio_register_all");
+    libpressio_register_all();
+  }
+  #if LIBPRESSIO_TOOLS_HAS_MPI
+  int requested=MPI_THREAD_MULTIPLE, provided;
+  MPI_Init_thread(&argc, &argv, requested, &provided);
+  #endif
+  {
+    #if LIBPRESSIO_TOOLS_HAS_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    #else
+    rank = 0;
+    #endif
+    cmdline_options opts;
+    {
+      phase_timer timer(registration, "parse_args");
+      opts = parse_args(argc, argv);
+    }
+    opts.startup_phases.insert(opts.startup_phases.begin(), registration.begin(), registration.end());
+    pressio library;
+
+    if (contains(opts.actions, Action::Serve)) {
+      serve_requests(library, opts);
+    } else {
+      run(library, opts);
+    }
   }
   #if LIBPRESSIO_TOOLS_HAS_MPI
   MPI_Finalize();
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/metrics.h>
+#include <libpressio_ext/cpp/options.h>
+#include <libpressio_ext/cpp/pressio.h>
+#include <std_compat/memory.h>
+
+#include "options.h"
+#include "profile.h"
+#include "serve.h"
+
+namespace {
+
+struct frame {
+  std::string name;
+  std::chrono::steady_clock::time_point begin;
+  double child_ms;
+};
+
+struct profile_sink {
+  std::mutex mutex;
+  graph_profile profile;
+};
+
+profile_sink& sink() {
+  static profile_sink s;
+  return s;
+}
+
+//modules call their children on the same thread, so a per-thread stack recovers the call tree
+thread_local std::vector<frame> stack;
+thread_local std::string phase;
+
+/**
+ * libpressio names the metrics of a compressor "<compressor name>/<metrics prefix>"
+ */
+std::string module_name(std::string const& metrics_name) {
+  std::string name = metrics_name.substr(0, metrics_name.rfind('/'));
+  if(!name.empty() && name.front() == '/') name.erase(0, 1);
+  return name;
+}
+
+size_t bytes_of(pressio_data const* data) {
+  return data ? data->size_in_bytes() : 0;
+}
+
+size_t bytes_of(compat::span<const pressio_data* const> const& data) {
+  size_t total = 0;
+  for (auto const* d : data) total += bytes_of(d);
+  return total;
+}
+
+class profile_plugin : public libpressio_metrics_plugin {
+  public:
+  int begin_compress_impl(pressio_data const*, pressio_data const*) override {
+    begin("compress");
+    return 0;
+  }
+  int end_compress_impl(pressio_data const* input, pressio_data const* output, int) override {
+    end(bytes_of(input), bytes_of(output));
+    return 0;
+  }
+  int begin_decompress_impl(pressio_data const*, pressio_data const*) override {
+    begin("decompress");
+    return 0;
+  }
+  int end_decompress_impl(pressio_data const* input, pressio_data const* output, int) override {
+    end(bytes_of(input), bytes_of(output));
+    return 0;
+  }
+  int begin_compress_many_impl(compat::span<const pressio_data* const> const&, compat::span<const pressio_data* const> const&) override {
+    begin("compress");
+    return 0;
+  }
+  int end_compress_many_impl(compat::span<const pressio_data* const> const& inputs, compat::span<const pressio_data* const> const& outputs, int) override {
+    end(bytes_of(inputs), bytes_of(outputs));
+    return 0;
+  }
+  int begin_decompress_many_impl(compat::span<const pressio_data* const> const&, compat::span<const pressio_data* const> const&) override {
+    begin("decompress");
+    return 0;
+  }
+  int end_decompress_many_impl(compat::span<const pressio_data* const> const& inputs, compat::span<const pressio_data* const> const& outputs, int) override {
+    end(bytes_of(inputs), bytes_of(outputs));
+    return 0;
+  }
+
+  pressio_options get_configuration_impl() const override {
+    pressio_options opts;
+    set(opts, "pressio:thread_safe", pressio_thread_safety_multiple);
+    return opts;
+  }
+
+  pressio_options get_metrics_results(pressio_options const&) override {
+    return pressio_options();
+  }
+
+  std::unique_ptr<libpressio_metrics_plugin> clone() override {
+    return compat::make_unique<profile_plugin>(*this);
+  }
+
+  const char* prefix() const override {
+    return "profile";
+  }
+
+  private:
+  void begin(const char* phase_name) {
+    if(stack.empty()) phase = phase_name;
+    stack.push_back(frame{module_name(get_name()), std::chrono::steady_clock::now(), 0});
+  }
+
+  void end(size_t input_bytes, size_t output_bytes) {
+    if(stack.empty()) return;
+    const auto now = std::chrono::steady_clock::now();
+    frame f = std::move(stack.back());
+    stack.pop_back();
+    const double inclusive = std::chrono::duration<double, std::milli>(now - f.begin).count();
+    const double exclusive = std::max(0.0, inclusive - f.child_ms);
+    if(!stack.empty()) stack.back().child_ms += inclusive;
+
+    std::string folded = phase;
+    for (auto const& parent : stack) folded += ';' + parent.name;
+    folded += ';' + f.name;
+
+    std::lock_guard<std::mutex> guard(sink().mutex);
+    auto& node = sink().profile.nodes[f.name];
+    node.inclusive_ms += inclusive;
+    node.exclusive_ms += exclusive;
+    node.calls++;
+    node.input_bytes += input_bytes;
+    node.output_bytes += output_bytes;
+    sink().profile.folded[folded] += exclusive * 1000;
+  }
+};
+
+pressio_register profile_metrics_plugin(metrics_plugins(), "pressio_tools_profile", [](){ return compat::make_unique<profile_plugin>(); });
+
+bool ends_with(std::string const& s, std::string const& suffix) {
+  return s.size() > suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void check(pressio_compressor& compressor, int rc) {
+  if(rc) {
+    if(rank == 0) {
+      std::cerr << compressor->error_msg() << std::endl;
+    }
+    tool_exit(compressor->error_code());
+  }
+}
+
+}
+
+graph_profile profile_compressor(pressio_compressor& compressor, cmdline_options const& opts) {
+  if(compressor->get_name().empty()) {
+    std::cerr << "fully quallify mode is required for profile-graph mode" << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+  if(opts.input.empty()) {
+    std::cerr << "profile-graph requires at least one input" << std::endl;
+    tool_exit(EXIT_FAILURE);
+  }
+
+  //every compressor in the tree gets its own instance of the profiling metric
+  const std::string type_suffix = ":pressio:type";
+  pressio_options metrics;
+  for (auto const& c : compressor->get_configuration()) {
+    if(!ends_with(c.first, type_suffix) || c.first.front() != '/') continue;
+    if(c.second.type() != pressio_option_charptr_type || c.second.get_value<std::string>() != "compressor") continue;
+    metrics.set(c.first.substr(0, c.first.size() - type_suffix.size()) + ":pressio:metric", std::string("pressio_tools_profile"));
+  }
+  //the metrics in place before profiling, including those configured with -m and -M, are put back afterwards
+  pressio_options previous;
+  auto const options = compressor->get_options();
+  for (auto const& metric : metrics) {
+    if(options.key_status(metric.first) == pressio_options_key_set) previous.set(metric.first, options.get(metric.first));
+  }
+  pressio_metrics root_metrics = compressor->get_metrics();
+  check(compressor, compressor->set_options(metrics));
+
+  {
+    std::lock_guard<std::mutex> guard(sink().mutex);
+    sink().profile = graph_profile{};
+  }
+  for (auto const& input : opts.input) {
+    pressio_data compressed = pressio_data::empty(pressio_byte_dtype, {});
+    pressio_data decompressed = pressio_data::owning(input.dtype(), input.dimensions());
+    check(compressor, compressor->compress(&input, &compressed));
+    check(compressor, compressor->decompress(&compressed, &decompressed));
+  }
+  check(compressor, compressor->set_options(previous));
+  compressor->set_metrics(root_metrics);
+
+  std::lock_guard<std::mutex> guard(sink().mutex);
+  if(sink().profile.nodes.empty() && rank == 0) {
+    std::cerr << "no module reported timings; this libpressio may not support pressio:metric" << std::endl;
+  }
+  return sink().profile;
+}
+
+void print_folded(graph_profile const& profile, std::ostream& out) {
+  for (auto const& [stack, us] : profile.folded) {
+    out << stack << ' ' << std::llround(us) << '\n';
+  }
+  out << std::flush;
+}
@@ -0,0 +1,37 @@
+#ifndef PROFILE_H_4NWQ8ZRE
+#define PROFILE_H_4NWQ8ZRE
+#include <map>
+#include <string>
+#include <libpressio_ext/cpp/compressor.h>
+#include "cmdline.h"
+
+/**
+ * what one module of a compressor tree did during a profiled run
+ */
+struct node_profile {
+  double inclusive_ms = 0;
+  double exclusive_ms = 0;
+  size_t calls = 0;
+  size_t input_bytes = 0;
+  size_t output_bytes = 0;
+};
+
+struct graph_profile {
+  /** keyed by module name, as in the fully qualified option keys */
+  std::map<std::string, node_profile> nodes;
+  /** exclusive time in microseconds of each ';' separated call stack */
+  std::map<std::string, double> folded;
+};
+
+/**
+ * attaches a timing metric to every module of a fully qualified compressor,
+ * compresses and decompresses each input once, and returns what each module did
+ */
+graph_profile profile_compressor(pressio_compressor& compressor, cmdline_options const& opts);
+
+/**
+ * prints the call stacks in the folded format read by flamegraph.pl
+ */
+void print_folded(graph_profile const& profile, std::ostream& out);
+
+#endif /* end of include guard: PROFILE_H_4NWQ8ZRE */
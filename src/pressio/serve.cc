@@ -0,0 +1,236 @@
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "serve.h"
+
+namespace {
+
+bool serving = false;
+
+/**
+ * splits a request line on whitespace; single and double quotes group words
+ * and a backslash escapes the next character
+ */
+std::vector<std::string> split_request(std::string const& line) {
+  std::vector<std::string> args{"pressio"};
+  std::string current;
+  bool in_word = false;
+  char quote = '\0';
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if(c == '\\' && i + 1 < line.size()) {
+      current += line[++i];
+      in_word = true;
+    } else if(quote) {
+      if(c == quote) quote = '\0';
+      else current += c;
+    } else if(c == '\'' || c == '"') {
+      quote = c;
+      in_word = true;
+    } else if(std::isspace(static_cast<unsigned char>(c))) {
+      if(in_word) args.emplace_back(std::move(current));
+      current.clear();
+      in_word = false;
+    } else {
+      current += c;
+      in_word = true;
+    }
+  }
+  if(quote) {
+    throw std::runtime_error("unterminated quote in request");
+  }
+  if(in_word) args.emplace_back(std::move(current));
+  return args;
+}
+
+/**
+ * sends the server's output to out_fd while a request runs, if out_fd is not negative
+ */
+class output_redirect {
+  public:
+  explicit output_redirect(int out_fd): saved_out(-1), saved_err(-1) {
+    flush();
+    if(out_fd < 0) return;
+    saved_out = dup(STDOUT_FILENO);
+    saved_err = dup(STDERR_FILENO);
+    dup2(out_fd, STDOUT_FILENO);
+    dup2(out_fd, STDERR_FILENO);
+  }
+  ~output_redirect() {
+    flush();
+    if(saved_out >= 0) {
+      dup2(saved_out, STDOUT_FILENO);
+      close(saved_out);
+    }
+    if(saved_err >= 0) {
+      dup2(saved_err, STDERR_FILENO);
+      close(saved_err);
+    }
+  }
+  output_redirect(output_redirect const&) = delete;
+  output_redirect& operator=(output_redirect const&) = delete;
+
+  private:
+  static void flush() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+  }
+  int saved_out, saved_err;
+};
+
+/**
+ * runs a request in the server with its output sent to out_fd, or to the
+ * server's output if out_fd is negative, and returns its exit status
+ */
+int run_request(request_handler const& run, std::vector<std::string> const& args, int out_fd) {
+  output_redirect redirect(out_fd);
+  try {
+    return run(args);
+  } catch(request_ended const& ended) {
+    return ended.status;
+  }
+}
+
+enum class request_status {
+  handled,
+  skipped,
+  shutdown
+};
+
+request_status handle_line(std::string const& line, request_handler const& run, int out_fd, int& status) {
+  auto first = line.find_first_not_of(" \t\r");
+  if(first == std::string::npos || line[first] == '#') return request_status::skipped;
+  if(line.compare(first, std::string::npos, "shutdown") == 0) return request_status::shutdown;
+  try {
+    status = run_request(run, split_request(line), out_fd);
+  } catch(std::exception const& ex) {
+    const std::string msg = std::string(ex.what()) + "\n";
+    if(out_fd >= 0) {
+      (void)!write(out_fd, msg.data(), msg.size());
+    } else {
+      std::cerr << msg;
+    }
+    status = EXIT_FAILURE;
+  }
+  return request_status::handled;
+}
+
+/**
+ * runs warm after a successful request; warming up is best effort since the
+ * request itself already succeeded
+ */
+void warm_after(request_status result, int status, warm_handler const& warm) {
+  if(result != request_status::handled || status != 0) return;
+  try {
+    warm();
+  } catch(request_ended const&) {
+  } catch(std::exception const&) {
+  }
+}
+
+void serve_stream(std::istream& in, request_handler const& run, warm_handler const& warm) {
+  std::string line;
+  size_t line_number = 0;
+  while(std::getline(in, line)) {
+    ++line_number;
+    int status = 0;
+    auto result = handle_line(line, run, -1, status);
+    if(result == request_status::shutdown) break;
+    if(result == request_status::handled && status != 0) {
+      std::cerr << "request on line " << line_number << " failed with status " << status << std::endl;
+    }
+    warm_after(result, status, warm);
+  }
+}
+
+bool serve_connection(int conn, request_handler const& run, warm_handler const& warm) {
+  std::string pending;
+  char buffer[4096];
+  ssize_t n;
+  while((n = read(conn, buffer, sizeof(buffer))) > 0) {
+    pending.append(buffer, n);
+    size_t newline;
+    while((newline = pending.find('\n')) != std::string::npos) {
+      std::string line = pending.substr(0, newline);
+      pending.erase(0, newline + 1);
+      int status = 0;
+      auto result = handle_line(line, run, conn, status);
+      if(result == request_status::shutdown) return false;
+      if(result == request_status::handled) {
+        const std::string reply = "status " + std::to_string(status) + "\n";
+        if(write(conn, reply.data(), reply.size()) < 0) return true;
+      }
+      warm_after(result, status, warm);
+    }
+  }
+  return true;
+}
+
+void serve_socket(std::string const& path, request_handler const& run, warm_handler const& warm) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(addr.sun_path)) {
+    throw std::runtime_error("socket path is too long: " + path);
+  }
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd == -1) {
+    throw std::runtime_error(std::string("failed to create socket: ") + std::strerror(errno));
+  }
+  unlink(path.c_str());
+  if(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(fd, 16) == -1) {
+    close(fd);
+    throw std::runtime_error("failed to listen on " + path + ": " + std::strerror(errno));
+  }
+  //a client that disconnects early should not take the server down
+  std::signal(SIGPIPE, SIG_IGN);
+
+  bool running = true;
+  while(running) {
+    int conn = accept(fd, nullptr, nullptr);
+    if(conn == -1) {
+      if(errno == EINTR) continue;
+      break;
+    }
+    running = serve_connection(conn, run, warm);
+    close(conn);
+  }
+  close(fd);
+  unlink(path.c_str());
+}
+
+}
+
+void tool_exit(int status) {
+  if(serving) throw request_ended{status};
+  exit(status);
+}
+
+void serve(std::string const& address, request_handler const& run, warm_handler const& warm) {
+  struct serving_guard {
+    serving_guard() { serving = true; }
+    ~serving_guard() { serving = false; }
+  } guard;
+  if(address == "-") {
+    serve_stream(std::cin, run, warm);
+    return;
+  }
+  struct stat info;
+  if(stat(address.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+    std::ifstream script(address);
+    serve_stream(script, run, warm);
+    return;
+  }
+  serve_socket(address, run, warm);
+}
@@ -0,0 +1,43 @@
+#ifndef SERVE_H_N6ZC1KUE
+#define SERVE_H_N6ZC1KUE
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * a request is the argument vector of a pressio invocation including argv[0]
+ */
+using request_handler = std::function<int(std::vector<std::string> const&)>;
+
+/**
+ * keeps the server ready for the next request after one succeeds
+ */
+using warm_handler = std::function<void()>;
+
+/**
+ * serves requests, one command line per line, until the input ends or a
+ * "shutdown" request is received.
+ *
+ * address is a path to a command script, "-" for stdin, or otherwise the path
+ * of a Unix socket to listen on; socket clients receive the request's output
+ * followed by a "status <code>" line.  Each request runs through run in the
+ * server itself so that it uses everything warm() has set up; a request that
+ * calls tool_exit ends with that status instead of taking the server down.
+ * After a request succeeds and its status has been reported, warm runs to
+ * keep the server ready for the next request.
+ */
+void serve(std::string const& address, request_handler const& run, warm_handler const& warm);
+
+/**
+ * thrown by tool_exit while serving to end the current request
+ */
+struct request_ended {
+  int status;
+};
+
+/**
+ * exits with status, or ends the current request with it while serving
+ */
+[[noreturn]] void tool_exit(int status);
+
+#endif /* end of include guard: SERVE_H_N6ZC1KUE */
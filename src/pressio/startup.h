@@ -0,0 +1,36 @@
+#ifndef STARTUP_H_K9TQ4VHB
+#define STARTUP_H_K9TQ4VHB
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * how long one step of starting up took, for -v
+ */
+struct startup_phase {
+  std::string name;
+  double ms;
+};
+
+/**
+ * records the time between its construction and destruction as a phase
+ */
+class phase_timer {
+  public:
+  phase_timer(std::vector<startup_phase>& phases, std::string name):
+    phases(phases), name(std::move(name)), begin(std::chrono::steady_clock::now()) {}
+  ~phase_timer() {
+    auto end = std::chrono::steady_clock::now();
+    phases.push_back({std::move(name), std::chrono::duration<double, std::milli>(end - begin).count()});
+  }
+  phase_timer(phase_timer const&)=delete;
+  phase_timer& operator=(phase_timer const&)=delete;
+
+  private:
+  std::vector<startup_phase>& phases;
+  std::string name;
+  std::chrono::steady_clock::time_point begin;
+};
+
+#endif /* end of include guard: STARTUP_H_K9TQ4VHB */
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+#include <libpressio_ext/cpp/data.h>
+#include <libpressio_ext/cpp/compressor.h>
+
+#include "container.h"
+#include "hyperslab_io.h"
+#include "options.h"
+#include "serve.h"
+#include "stream.h"
+
+namespace {
+
+const size_t default_chunk_bytes = 64ull * 1024 * 1024;
+
+void stream_compress_one(pressio_compressor& compressor, std::string const& compressor_id, pressio_io& io, io_description const& input, io_description const& output, compat::optional<size_t> const& chunk_size) {
+  if(!input.dtype || input.dims.empty()) {
+    throw std::runtime_error("stream-compress requires -t and -d for each input");
+  }
+  if(!output.path) {
+    throw std::runtime_error("stream-compress requires -w for each input");
+  }
+
+  auto reader = make_hyperslab_reader(io, input);
+  const hyperslab selection = resolve_selection(input);
+  const size_t slowest = selection.count.back();
+  const size_t slab_bytes = std::accumulate(selection.count.begin(), selection.count.end() - 1,
+      pressio_dtype_size(*input.dtype), std::multiplies<>{});
+  const size_t chunk = std::max<size_t>(1, std::min(slowest,
+      chunk_size.value_or(default_chunk_bytes / std::max<size_t>(1, slab_bytes))));
+
+  container_header header;
+  header.dtype = *input.dtype;
+  header.dims = selection.count;
+  header.block_extent = chunk;
+  header.compressor_id = compressor_id;
+  header.compressor_options = options_to_string(compressor->get_options());
+  std::ofstream out(*output.path, std::ios::binary | std::ios::trunc);
+  if(!out) {
+    throw std::runtime_error("failed to open " + *output.path + " for writing");
+  }
+  container_writer writer(out, header);
+
+  hyperslab chunk_slab = selection;
+  chunk_slab.count.back() = chunk;
+  pressio_data buffer = pressio_data::owning(*input.dtype, chunk_slab.count);
+  pressio_data compressed = pressio_data::empty(pressio_byte_dtype, {});
+
+  for (size_t start = 0; start < slowest; start += chunk) {
+    chunk_slab.start.back() = selection.start.back() + start;
+    chunk_slab.count.back() = std::min(chunk, slowest - start);
+    pressio_data slab = pressio_data::nonowning(*input.dtype, buffer.data(), chunk_slab.count);
+    reader->read_into(chunk_slab, slab);
+    if(compressor->compress(&slab, &compressed)) {
+      if(rank == 0) {
+        std::cerr << compressor->error_msg() << std::endl;
+      }
+      tool_exit(compressor->error_code());
+    }
+    writer.append(compressed);
+  }
+  writer.finish();
+}
+
+}
+
+void stream_compress(pressio_compressor& compressor, cmdline_options const& opts) {
+  if(opts.compressed_descriptions.size() < opts.input_descriptions.size()) {
+    if(rank == 0) {
+      std::cerr << "stream-compress failed: stream-compress requires -w for each input" << std::endl;
+    }
+    tool_exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < opts.input_descriptions.size(); ++i) {
+    try {
+      pressio_io io = opts.input_file_action[i];
+      stream_compress_one(compressor, opts.compressor, io, opts.input_descriptions[i], opts.compressed_descriptions[i], opts.chunk_size);
+    } catch(std::exception const& ex) {
+      if(rank == 0) {
+        std::cerr << "stream-compress failed: " << ex.what() << std::endl;
+      }
+      tool_exit(EXIT_FAILURE);
+    }
+  }
+}
@@ -0,0 +1,13 @@
+#ifndef STREAM_H_H7GRUE2P
+#define STREAM_H_H7GRUE2P
+#include <libpressio_ext/cpp/compressor.h>
+#include "cmdline.h"
+
+/**
+ * compresses each input a chunk of the slowest dimension at a time and appends
+ * each compressed chunk to a chunked container at the compressed file path so
+ * that only a few chunks are resident in memory at once
+ */
+void stream_compress(pressio_compressor& compressor, cmdline_options const& opts);
+
+#endif /* end of include guard: STREAM_H_H7GRUE2P */
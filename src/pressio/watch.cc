@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fnmatch.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "pipeline.h"
+#include "watch.h"
+
+namespace {
+
+volatile sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+  stop_requested = 1;
+}
+
+/**
+ * closes the inotify descriptor and restores the signal handlers and mask on
+ * every exit path
+ */
+class watch_guard {
+  public:
+  watch_guard(): fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+    if(fd == -1) {
+      throw std::runtime_error(std::string("failed to initialize inotify: ") + std::strerror(errno));
+    }
+    stop_requested = 0;
+    struct sigaction action {};
+    action.sa_handler = request_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+    //the signals stay blocked except inside ppoll so a stop request cannot slip in between checking for it and waiting
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+  }
+  ~watch_guard() {
+    close(fd);
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+    sigaction(SIGINT, &old_int, nullptr);
+    sigaction(SIGTERM, &old_term, nullptr);
+  }
+  watch_guard(watch_guard const&) = delete;
+  watch_guard& operator=(watch_guard const&) = delete;
+
+  int fd;
+  sigset_t old_mask;
+  private:
+  struct sigaction old_int, old_term;
+};
+
+}
+
+void watch_directory(std::string const& directory, std::string const& pattern, size_t workers, size_t depth, watch_handler const& handle) {
+  watch_guard guard;
+  if(inotify_add_watch(guard.fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR) == -1) {
+    throw std::runtime_error("failed to watch " + directory + ": " + std::strerror(errno));
+  }
+
+  //workers are started with the stop signals blocked so that they are only delivered to this thread
+  bounded_queue<std::string> queue(depth);
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < std::max<size_t>(1, workers); ++w) {
+    threads.emplace_back([&queue, &handle, w]{
+      while(auto path = queue.pop()) {
+        try {
+          handle(w, *path);
+        } catch(std::exception const& ex) {
+          std::cerr << "failed to compress " << *path << ": " << ex.what() << std::endl;
+        }
+      }
+    });
+  }
+
+  alignas(struct inotify_event) char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+  bool watching = true;
+  while(watching && !stop_requested) {
+    struct pollfd pfd {guard.fd, POLLIN, 0};
+    if(ppoll(&pfd, 1, nullptr, &guard.old_mask) == -1) {
+      if(errno == EINTR) continue;
+      std::cerr << "failed to wait for " << directory << ": " << std::strerror(errno) << std::endl;
+      break;
+    }
+    ssize_t len;
+    while((len = read(guard.fd, buffer, sizeof(buffer))) > 0) {
+      for (char* ptr = buffer; ptr < buffer + len;) {
+        auto const* event = reinterpret_cast<struct inotify_event const*>(ptr);
+        ptr += sizeof(struct inotify_event) + event->len;
+        if(event->mask & IN_Q_OVERFLOW) {
+          std::cerr << "events were lost while the queue was full, some files in " << directory << " were not compressed" << std::endl;
+        } else if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+          std::cerr << directory << " was removed, stopping" << std::endl;
+          watching = false;
+        } else if(event->len && fnmatch(pattern.c_str(), event->name, FNM_PERIOD) == 0) {
+          queue.push(directory + '/' + event->name);
+        }
+      }
+    }
+  }
+
+  queue.close();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef WATCH_H_Q3VD8MXS
+#define WATCH_H_Q3VD8MXS
+#include <functional>
+#include <string>
+
+/**
+ * handles one file that appeared in a watched directory on the given worker
+ */
+using watch_handler = std::function<void(size_t worker, std::string const& path)>;
+
+/**
+ * calls handle for each file in directory whose name matches the shell
+ * pattern once it is completely written, that is closed after writing or
+ * moved into the directory.  Files are handled on up to workers threads and at
+ * most depth more wait for a free thread; while the queue is full new events
+ * wait in the kernel.  Errors from handle are reported and the file skipped.
+ *
+ * runs until SIGINT or SIGTERM, then finishes the queued files and returns.
+ */
+void watch_directory(std::string const& directory, std::string const& pattern, size_t workers, size_t depth, watch_handler const& handle);
+
+#endif /* end of include guard: WATCH_H_Q3VD8MXS */
@@ -1,5 +1,8 @@
 #include "cmdline.h"
+#include <cctype>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <unistd.h>
 
 
@@ -11,20 +14,42 @@ pressio_batch [args] [metrics...]
 -c compressor_config_file path to the compressor configuration, default: "./compressors.json"
 -d dataset_config_file path to the dataset configuration, default: "./datasets.json"
 -r replicats the number of times to replicate each configuration, default: 1
+-j threads the number of configurations to run concurrently, each with its own compressor and metrics; results are still written in order, default: 1
 -m metrics_config file path the metrics configuration, default: "./metrics.json"
+-b cache_budget MiB of datasets each rank of pressio_batch_mpi keeps loaded between tasks; the most recent dataset is always kept, default: 0
+-s load each dataset once per node into an MPI-3 shared memory window that every rank of pressio_batch_mpi on the node reads; the datasets are processed one after another
 -w compressed_dir output the compressed data files to this directory
 -W decompressed_dir output the decompressed data files to this directory
 )";
 };
 
+/**
+ * value as a positive count, or 0 if it is not one
+ */
+static unsigned int
+parse_count(std::string const& value)
+{
+  //stoul would wrap a negative count around instead of rejecting it
+  if(value.empty() || !std::isdigit(static_cast<unsigned char>(value.front()))) return 0;
+  try {
+    const unsigned long count = std::stoul(value);
+    return count <= std::numeric_limits<unsigned int>::max() ? static_cast<unsigned int>(count) : 0;
+  } catch(std::logic_error const&) {
+    return 0;
+  }
+}
+
 cmdline
 parse_args(int argc, char* argv[], bool verbose)
 {
   cmdline args;
 
   int opt;
-  while ((opt = getopt(argc, argv, "c:d:hr:m:w:W:")) != -1) {
+  while ((opt = getopt(argc, argv, "b:c:d:hj:r:m:sw:W:")) != -1) {
     switch (opt) {
+      case 'b':
+        args.cache_budget = std::stoull(optarg);
+        break;
       case 'd':
         args.datasets = optarg;
         break;
@@ -35,12 +60,22 @@ parse_args(int argc, char* argv[], bool verbose)
         if(verbose) usage();
         args.error_code = 1;
         break;
+      case 'j':
+        args.threads = parse_count(optarg);
+        if(args.threads == 0) {
+          if(verbose) std::cerr << "-j requires a positive number of threads" << std::endl;
+          args.error_code = 1;
+        }
+        break;
       case 'r':
         args.replicats = std::stoi(optarg);
         break;
       case 'm':
         args.metrics = optarg;
         break;
+      case 's':
+        args.shared_datasets = true;
+        break;
       case 'w':
         args.compressed_dir = optarg;
         break;
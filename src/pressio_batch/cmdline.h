@@ -10,6 +10,9 @@ struct cmdline
   std::string decompressed_dir;
   std::string compressed_dir;
   unsigned int replicats = 1;
+  unsigned int threads = 1;
+  size_t cache_budget = 0;
+  bool shared_datasets = false;
   int error_code = 0;
 };
 
@@ -1,10 +1,13 @@
 #include "compressor_configs.h"
 #include <iostream>
+#include <mutex>
 #include <libpressio.h>
+#include <libpressio_ext/cpp/compressor.h>
 #include <libpressio_ext/cpp/options.h>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <utils/string_options.h>
+#include <utils/option_index.h>
 
 namespace pt = boost::property_tree;
 using namespace std::literals;
@@ -14,36 +17,53 @@ struct compressor_config_impl: public compressor_config {
   std::string compressor_id;
   std::multimap<std::string, std::string> config_options;
   std::multimap<std::string, std::string> early_config_options;
+  pressio_compressor* prototype = nullptr;
+  std::mutex prototype_mutex;
 
-  pressio_compressor* load(pressio* library) {
-    pressio_compressor* compressor = pressio_get_compressor(library, compressor_id.c_str());
+  ~compressor_config_impl() {
+    if(prototype) pressio_compressor_release(prototype);
+  }
+
+  void prepare(pressio* library) {
+    prototype = pressio_get_compressor(library, compressor_id.c_str());
+    if(!prototype) {
+      throw std::runtime_error("failed to load compressor "s + compressor_id + " for " + name);
+    }
 
-    auto early_config_opts = options_from_multimap(early_config_options);
-    pressio_options* early_options = pressio_compressor_get_options(compressor);
-    if(pressio_compressor_set_options(compressor, early_options)) {
-      throw std::runtime_error("failed to set "s + pressio_compressor_error_msg(compressor));
+    if(!early_config_options.empty()) {
+      auto early_config_opts = options_from_multimap(early_config_options);
+      if(pressio_compressor_set_options(prototype, &early_config_opts)) {
+        throw std::runtime_error("failed to set "s + pressio_compressor_error_msg(prototype));
+      }
     }
 
-    pressio_options* options = pressio_compressor_get_options(compressor);
-    auto config_opts = options_from_multimap(config_options);
-    for (auto& [setting, value] : config_opts) {
-      auto status = pressio_options_cast_set(options, setting.c_str(), &value, pressio_conversion_special);
-      if(status != pressio_options_key_set) throw std::runtime_error("failed to assign "s + setting);
+    option_index index((*prototype)->get_options());
+    pressio_options resolved;
+    for (auto& [setting, value] : options_from_multimap(config_options)) {
+      pressio_option option;
+      if(index.cast(setting, value, option) != pressio_options_key_set) throw std::runtime_error("failed to assign "s + setting + " for " + name);
+      resolved.set(setting, option);
     }
-    if(pressio_compressor_check_options(compressor, options)) {
-      throw std::runtime_error("failed to check "s + pressio_compressor_error_msg(compressor));
+    if(pressio_compressor_check_options(prototype, &resolved)) {
+      throw std::runtime_error("failed to check "s + pressio_compressor_error_msg(prototype));
     }
-    if(pressio_compressor_set_options(compressor, options)) {
-      throw std::runtime_error("failed to set "s + pressio_compressor_error_msg(compressor));
+    if(pressio_compressor_set_options(prototype, &resolved)) {
+      throw std::runtime_error("failed to set "s + pressio_compressor_error_msg(prototype));
+    }
+  }
+
+  pressio_compressor* load() override {
+    std::lock_guard<std::mutex> guard(prototype_mutex);
+    pressio_compressor* compressor = pressio_compressor_clone(prototype);
+    if(!compressor) {
+      throw std::runtime_error("failed to clone "s + name);
     }
-    pressio_options_free(options);
-    pressio_options_free(early_options);
     return compressor;
   }
-  std::string const& get_name() { return name; }
+  std::string const& get_name() override { return name; }
 };
 
-std::vector<std::unique_ptr<compressor_config>> load_compressors(std::string const& compressor_config_path, bool verbose) {
+std::vector<std::unique_ptr<compressor_config>> load_compressors(pressio* library, std::string const& compressor_config_path, bool verbose) {
   std::vector<std::unique_ptr<compressor_config>> compressors;
   pt::ptree compressor_tree;
   pt::read_json(compressor_config_path, compressor_tree);
@@ -55,7 +75,27 @@ std::vector<std::unique_ptr<compressor_config>> load_compressors(std::string con
       for(auto& option: config.get_child("options")) {
         compressor_config->config_options.emplace(option.first, option.second.get_value<std::string>());
       }
+      if(config.find("early_options") != config.not_found()) {
+        for(auto& option: config.get_child("early_options")) {
+          compressor_config->early_config_options.emplace(option.first, option.second.get_value<std::string>());
+        }
+      }
+      compressor_config->prepare(library);
       compressors.emplace_back(std::move(compressor_config));
   }
   return compressors;
 }
+
+warm_compressors::warm_compressors(std::vector<std::unique_ptr<compressor_config>>& configs):
+  configs(configs), instances(configs.size(), nullptr) {}
+
+warm_compressors::~warm_compressors() {
+  for (auto* instance : instances) {
+    if(instance) pressio_compressor_release(instance);
+  }
+}
+
+pressio_compressor* warm_compressors::get(size_t compressor_id) {
+  if(!instances[compressor_id]) instances[compressor_id] = configs[compressor_id]->load();
+  return instances[compressor_id];
+}
@@ -8,8 +8,32 @@ struct pressio_compressor;
 
 struct compressor_config {
   virtual ~compressor_config()=default;
-  virtual pressio_compressor* load(pressio* library)=0;
+  /** a new instance of this configuration, cloned from its validated prototype */
+  virtual pressio_compressor* load()=0;
   virtual std::string const& get_name()=0;
 };
 
-std::vector<std::unique_ptr<compressor_config>> load_compressors(std::string const& dataset_config_path, bool verbose = false);
+/**
+ * reads the configurations and creates, configures, and checks one prototype
+ * of each, so that an invalid configuration fails here rather than in a task
+ */
+std::vector<std::unique_ptr<compressor_config>> load_compressors(pressio* library, std::string const& dataset_config_path, bool verbose = false);
+
+/**
+ * instances of each configuration kept warm for the later tasks of one
+ * worker so that plugins with expensive setup are only set up once per
+ * worker; not thread safe, give each worker its own
+ */
+class warm_compressors {
+  public:
+  explicit warm_compressors(std::vector<std::unique_ptr<compressor_config>>& configs);
+  ~warm_compressors();
+  warm_compressors(warm_compressors const&) = delete;
+  warm_compressors& operator=(warm_compressors const&) = delete;
+
+  pressio_compressor* get(size_t compressor_id);
+
+  private:
+  std::vector<std::unique_ptr<compressor_config>>& configs;
+  std::vector<pressio_compressor*> instances;
+};
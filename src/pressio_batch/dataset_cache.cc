@@ -0,0 +1,33 @@
+#include "dataset_cache.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <libpressio.h>
+
+using namespace std::literals;
+
+lru_dataset_cache::lru_dataset_cache(std::vector<std::unique_ptr<dataset>>& datasets, size_t budget):
+  datasets(datasets), budget(budget) {}
+
+std::shared_ptr<pressio_data const> lru_dataset_cache::get(size_t dataset_id) {
+  auto it = std::find_if(std::begin(entries), std::end(entries), [dataset_id](entry const& e) {
+      return e.dataset_id == dataset_id;
+  });
+  if(it != std::end(entries)) {
+    entries.splice(std::begin(entries), entries, it);
+    return entries.front().data;
+  }
+
+  pressio_data* loaded = datasets[dataset_id]->load();
+  if(!loaded) throw std::runtime_error("failed to load dataset "s + datasets[dataset_id]->get_name());
+  num_loads++;
+  std::shared_ptr<pressio_data const> data(loaded, pressio_data_free);
+  const size_t bytes = pressio_data_get_bytes(loaded);
+  entries.push_front(entry{dataset_id, data, bytes});
+  resident += bytes;
+  while(entries.size() > 1 && resident > budget) {
+    resident -= entries.back().bytes;
+    entries.pop_back();
+  }
+  return data;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <vector>
+#include "datasets.h"
+
+struct pressio_data;
+
+/**
+ * keeps the most recently used datasets loaded while they fit in budget
+ * bytes; the dataset returned last is always kept even if it alone exceeds
+ * the budget.  Evicted datasets are freed once no caller holds them.
+ */
+class lru_dataset_cache {
+  public:
+  lru_dataset_cache(std::vector<std::unique_ptr<dataset>>& datasets, size_t budget);
+
+  std::shared_ptr<pressio_data const> get(size_t dataset_id);
+
+  /** the number of times a dataset was read because it was not resident */
+  size_t loads() const { return num_loads; }
+
+  private:
+  struct entry {
+    size_t dataset_id;
+    std::shared_ptr<pressio_data const> data;
+    size_t bytes;
+  };
+  std::vector<std::unique_ptr<dataset>>& datasets;
+  std::list<entry> entries;
+  size_t budget;
+  size_t resident = 0;
+  size_t num_loads = 0;
+};
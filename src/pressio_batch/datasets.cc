@@ -42,14 +42,19 @@ struct generic_dataset_t: public dataset {
   pressio_dtype type;
 
   pressio_data* load() override {
-    pressio_data* desc = (dims.empty())
-                           ? nullptr
-                           : pressio_data_new_empty(type, dims.size(), dims.data());
-    
+    pressio_data* desc = describe();
     auto ret =  pressio_io_read(&io, desc);
     pressio_data_free(desc);
     return ret;
   }
+
+  pressio_data* describe() override {
+    return (dims.empty()) ? nullptr : pressio_data_new_empty(type, dims.size(), dims.data());
+  }
+
+  pressio_data* load_into(pressio_data* buffer) override {
+    return pressio_io_read(&io, buffer);
+  }
 };
 
 pressio_dtype to_pressio_dtype(std::string const& name) {
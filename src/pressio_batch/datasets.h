@@ -9,6 +9,16 @@ struct dataset {
   dataset(std::string name): name(name) {}
   virtual ~dataset()=default;
   virtual pressio_data* load()=0;
+  /**
+   * an empty pressio_data with the dataset's dtype and dimensions if they are
+   * known without loading it, otherwise nullptr
+   */
+  virtual pressio_data* describe() { return nullptr; }
+  /**
+   * loads the dataset, reading into buffer if the format supports it; buffer
+   * has the shape returned by describe
+   */
+  virtual pressio_data* load_into(pressio_data* buffer) { (void)buffer; return load(); }
   std::string const& get_name() {return name;}
 
   private:
@@ -1,11 +1,18 @@
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <string>
 #include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <libpressio.h>
 #include <libpressio_meta.h>
 #include <libpressio_ext/cpp/options.h>
+#include <std_compat/optional.h>
 
 #include "compressor_configs.h"
 #include "datasets.h"
@@ -13,82 +20,202 @@
 #include "io.h"
 #include "metrics.h"
 
+using namespace std::literals;
 
+namespace {
 
-int
-main(int argc, char* argv[])
-{
-  auto args = parse_args(argc, argv);
-  libpressio_register_all();
+/**
+ * all replicates of one compressor configuration on one dataset
+ */
+struct task {
+  size_t dataset_id;
+  size_t compressor_id;
+};
 
-  auto library = pressio_instance();
+/**
+ * loads each dataset on first use and frees it once its last task finishes so
+ * that only the datasets in flight are resident
+ */
+class shared_inputs {
+  public:
+  shared_inputs(std::vector<std::unique_ptr<dataset>>& datasets, std::vector<task> const& tasks):
+    datasets(datasets), entries(datasets.size()) {
+    for (auto const& t : tasks) {
+      entries[t.dataset_id].uses++;
+    }
+  }
 
-  auto datasets = load_datasets(args.datasets);
-  auto compressor_configs = load_compressors(args.compressors);
-  auto metrics_config = load_metrics(args.metrics);
-  auto metrics = metrics_config->load(library);
-  bool first = true;
-
-  for (auto& dataset : datasets) {
-    auto input = dataset->load();
-    for (auto& compressor_factory : compressor_configs) {
-      auto compressor = compressor_factory->load(library);
-
-      std::string task_name = dataset->get_name() + "," + compressor_factory->get_name();
-      pressio_options* configuration_name = pressio_options_new();
-      pressio_options_set_string(configuration_name, "external:config_name", task_name.c_str());
-      pressio_metrics_set_options(metrics, configuration_name);
-      pressio_options_free(configuration_name);
-      pressio_compressor_set_metrics(compressor, metrics);
-
-      for (int i = 0; i < args.replicats; ++i) {
-
-        auto compressed =
-          pressio_data_new_empty(pressio_byte_dtype, 0, nullptr);
-        auto decompressed = pressio_data_new_clone(input);
-        if (pressio_compressor_compress(compressor, input, compressed)) {
-          std::cerr << "compression failed" << std::endl;
-          pressio_data_free(compressed);
-          pressio_data_free(decompressed);
-          pressio_compressor_release(compressor);
-          continue;
-        }
-        if (pressio_compressor_decompress(compressor, compressed,
-                                          decompressed)) {
-          std::cerr << "decompression failed" << std::endl;
-          pressio_data_free(compressed);
-          pressio_data_free(decompressed);
-          pressio_compressor_release(compressor);
-          continue;
-        }
+  pressio_data const* acquire(size_t id) {
+    auto& entry = entries[id];
+    std::lock_guard<std::mutex> guard(entry.mutex);
+    if(!entry.data) {
+      entry.data = datasets[id]->load();
+      if(!entry.data) throw std::runtime_error("failed to load dataset "s + datasets[id]->get_name());
+    }
+    return entry.data;
+  }
 
-        auto metrics_results =
-          pressio_compressor_get_metrics_results(compressor);
+  void release(size_t id) {
+    auto& entry = entries[id];
+    std::lock_guard<std::mutex> guard(entry.mutex);
+    if(--entry.uses == 0 && entry.data) {
+      pressio_data_free(entry.data);
+      entry.data = nullptr;
+    }
+  }
+
+  private:
+  struct entry {
+    std::mutex mutex;
+    pressio_data* data = nullptr;
+    size_t uses = 0;
+  };
+  std::vector<std::unique_ptr<dataset>>& datasets;
+  std::vector<entry> entries;
+};
+
+/**
+ * collects the metrics of tasks that finish in any order and writes them in
+ * task order so that the CSV does not depend on scheduling
+ */
+class ordered_writer {
+  public:
+  explicit ordered_writer(size_t num_tasks): results(num_tasks) {}
+
+  void complete(size_t task_id, std::vector<pressio_options*> replicates) {
+    std::lock_guard<std::mutex> guard(mutex);
+    results[task_id] = std::move(replicates);
+    ready.notify_one();
+  }
+
+  void write(std::ostream& out, std::vector<std::string> const& task_names, std::vector<std::string>& fields) {
+    bool first = true;
+    for (size_t task_id = 0; task_id < results.size(); ++task_id) {
+      std::vector<pressio_options*> replicates;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&]{ return results[task_id].has_value(); });
+        replicates = std::move(*results[task_id]);
+      }
+      for (auto* metrics_results : replicates) {
         if (first) {
           first = false;
-          if (args.fields.empty())
+          if (fields.empty())
             std::transform(std::begin(*metrics_results),
                            std::end(*metrics_results),
-                           std::back_inserter(args.fields),
+                           std::back_inserter(fields),
                            [](auto const& iterator) { return iterator.first; });
-          std::cout << "dataset,configuration";
-          for (auto const& field : args.fields) {
-            std::cout << ',' << field;
+          out << "dataset,configuration";
+          for (auto const& field : fields) {
+            out << ',' << field;
           }
-          std::cout << std::endl;
+          out << std::endl;
         }
-        output_csv(std::cout,
-                   task_name,
-                   metrics_results, args.fields);
+        output_csv(out, task_names[task_id], metrics_results, fields);
         pressio_options_free(metrics_results);
-        pressio_data_free(compressed);
-        pressio_data_free(decompressed);
       }
-      pressio_compressor_release(compressor);
     }
-    pressio_data_free(input);
   }
-  pressio_metrics_free(metrics);
+
+  private:
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::vector<compat::optional<std::vector<pressio_options*>>> results;
+};
+
+/**
+ * runs every replicate of a task on the worker's instance of its
+ * configuration; failed replicates are reported and left out of the results
+ */
+std::vector<pressio_options*> run_task(pressio_compressor* compressor, pressio_metrics* metrics,
+    pressio_data const* input, std::string const& task_name, unsigned int replicats) {
+  std::vector<pressio_options*> results;
+
+  pressio_options* configuration_name = pressio_options_new();
+  pressio_options_set_string(configuration_name, "external:config_name", task_name.c_str());
+  pressio_metrics_set_options(metrics, configuration_name);
+  pressio_options_free(configuration_name);
+  pressio_compressor_set_metrics(compressor, metrics);
+
+  //decompression allocates the output, so copying the input would only add a copy of the dataset
+  std::vector<size_t> dims(pressio_data_num_dimensions(input));
+  for (size_t i = 0; i < dims.size(); ++i) dims[i] = pressio_data_get_dimension(input, i);
+  for (unsigned int i = 0; i < replicats; ++i) {
+    auto compressed =
+      pressio_data_new_empty(pressio_byte_dtype, 0, nullptr);
+    auto decompressed = pressio_data_new_empty(pressio_data_dtype(input), dims.size(), dims.data());
+    if (pressio_compressor_compress(compressor, input, compressed)) {
+      std::cerr << "compression failed" << std::endl;
+    } else if (pressio_compressor_decompress(compressor, compressed,
+                                             decompressed)) {
+      std::cerr << "decompression failed" << std::endl;
+    } else {
+      results.push_back(pressio_compressor_get_metrics_results(compressor));
+    }
+    pressio_data_free(compressed);
+    pressio_data_free(decompressed);
+  }
+  return results;
+}
+
+}
+
+int
+main(int argc, char* argv[])
+{
+  auto args = parse_args(argc, argv, true);
+  if(args.error_code) return args.error_code;
+  libpressio_register_all();
+
+  auto library = pressio_instance();
+  auto datasets = load_datasets(args.datasets);
+  auto compressor_configs = load_compressors(library, args.compressors);
+  auto metrics_config = load_metrics(args.metrics);
+
+  std::vector<task> tasks;
+  std::vector<std::string> task_names;
+  for (size_t dataset_id = 0; dataset_id < datasets.size(); ++dataset_id) {
+    for (size_t compressor_id = 0; compressor_id < compressor_configs.size(); ++compressor_id) {
+      tasks.push_back(task{dataset_id, compressor_id});
+      task_names.push_back(datasets[dataset_id]->get_name() + "," + compressor_configs[compressor_id]->get_name());
+    }
+  }
+
+  shared_inputs inputs(datasets, tasks);
+  ordered_writer writer(tasks.size());
+  std::atomic<size_t> next{0};
+
+  //each worker sets external:config_name on its own metrics, so they cannot be shared.
+  //tasks stay in dataset order so that few datasets are resident at once, which
+  //means every worker may warm an instance of every configuration
+  auto work = [&]() {
+    auto worker_library = pressio_instance();
+    auto metrics = metrics_config->load(worker_library);
+    warm_compressors compressors(compressor_configs);
+    for (size_t task_id = next++; task_id < tasks.size(); task_id = next++) {
+      auto const& t = tasks[task_id];
+      std::vector<pressio_options*> results;
+      try {
+        results = run_task(compressors.get(t.compressor_id), metrics,
+            inputs.acquire(t.dataset_id), task_names[task_id], args.replicats);
+      } catch(std::exception const& ex) {
+        std::cerr << task_names[task_id] << ": " << ex.what() << std::endl;
+      }
+      inputs.release(t.dataset_id);
+      writer.complete(task_id, std::move(results));
+    }
+    pressio_metrics_free(metrics);
+    pressio_release(worker_library);
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned int w = 0; w < std::max(1u, args.threads); ++w) {
+    workers.emplace_back(work);
+  }
+  writer.write(std::cout, task_names, args.fields);
+  for (auto& worker : workers) {
+    worker.join();
+  }
   pressio_release(library);
   return 0;
 }
@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
 #include <mpi.h>
 
 #include <libpressio.h>
@@ -9,6 +13,8 @@
 
 #include "cmdline.h"
 #include "datasets.h"
+#include "dataset_cache.h"
+#include "shared_dataset.h"
 #include "compressor_configs.h"
 #include "io.h"
 #include "metrics.h"
@@ -61,15 +67,20 @@ int main(int argc, char *argv[])
   auto metrics_config = load_metrics(cmdline.metrics, rank==0);
   auto metrics = metrics_config->load(library);
   auto datasets = load_datasets(cmdline.datasets, rank == 0);
-  auto compressors = load_compressors(cmdline.compressors, rank == 0);
-
-  //create the list of tasks
+  auto compressors = load_compressors(library, cmdline.compressors, rank == 0);
+  warm_compressors instances(compressors);
+  //budgets too large to count in bytes just mean keep everything
+  const size_t max_budget_mib = std::numeric_limits<size_t>::max() >> 20;
+  lru_dataset_cache cache(datasets, (cmdline.cache_budget > max_budget_mib) ? std::numeric_limits<size_t>::max() : cmdline.cache_budget << 20);
+
+  //create the list of tasks; the queue hands out tasks in order, so grouping
+  //them by dataset keeps each rank on the dataset it already holds
   std::vector<RequestType> tasks;
   std::map<int, std::string> task_to_name;
   int task_id = 0;
-  for (int replicant_id = 0; replicant_id < cmdline.replicats; ++replicant_id) {
-    for (int dataset_id = 0; dataset_id < datasets.size(); ++dataset_id) {
-      for (int compressor_id = 0; compressor_id < compressors.size(); ++compressor_id) {
+  for (int dataset_id = 0; dataset_id < datasets.size(); ++dataset_id) {
+    for (int compressor_id = 0; compressor_id < compressors.size(); ++compressor_id) {
+      for (int replicant_id = 0; replicant_id < cmdline.replicats; ++replicant_id) {
         task_to_name[task_id] = datasets[dataset_id]->get_name() + \
                                 "," + compressors[compressor_id]->get_name();
         tasks.emplace_back(task_id++, dataset_id, compressor_id);
@@ -104,70 +115,110 @@ int main(int argc, char *argv[])
   std::map<int,pressio_options> responses;
   std::map<int,int> response_count;
 
+  //with -s, the node's shared copy of the dataset being worked on
+  std::shared_ptr<pressio_data const> node_input;
+
+  auto worker = [&](RequestType request) {
+    auto [task_id, dataset_id, compressor_id] = request;
+    std::vector<ResponseType> task_responses;
+    pressio_compressor* compressor;
+    std::shared_ptr<pressio_data const> input;
+    try {
+      compressor = instances.get(compressor_id);
+      input = node_input ? node_input : cache.get(dataset_id);
+    } catch(std::exception const& ex) {
+      //an exception escaping the worker would leave the queue waiting on this task forever
+      std::cerr << task_to_name[task_id] << ": " << ex.what() << std::endl;
+      return task_responses;
+    }
+    auto input_data = input.get();
+    auto compressed = pressio_data_new_empty(pressio_byte_dtype, 0, nullptr);
+    //decompression allocates the output, so copying the input would only add a copy of the dataset
+    std::vector<size_t> dims(pressio_data_num_dimensions(input_data));
+    for (size_t i = 0; i < dims.size(); ++i) dims[i] = pressio_data_get_dimension(input_data, i);
+    auto decompressed = pressio_data_new_empty(pressio_data_dtype(input_data), dims.size(), dims.data());
+
+    pressio_options* configuration_name = pressio_options_new();
+    pressio_options_set_string(configuration_name, "external:config_name", task_to_name[task_id].c_str());
+    pressio_metrics_set_options(metrics, configuration_name);
+    pressio_options_free(configuration_name);
+
+    pressio_compressor_set_metrics(compressor, metrics);
+    pressio_compressor_compress(compressor, input_data, compressed);
+    pressio_compressor_decompress(compressor, compressed, decompressed);
+
+    if(not cmdline.compressed_dir.empty()) {
+      auto compressed_path = cmdline.compressed_dir + "/" + task_to_name[task_id];
+      pressio_io_data_path_write(compressed, compressed_path.c_str());
+    }
+    if(not cmdline.decompressed_dir.empty()) {
+      auto decompressed_path = cmdline.decompressed_dir + "/" + task_to_name[task_id];
+      pressio_io_data_path_write(decompressed, decompressed_path.c_str());
+    }
+
+    auto metrics_results = pressio_compressor_get_metrics_results(compressor);
+    for (auto metric_result : *metrics_results) {
+      auto double_result = metric_result.second.as(pressio_option_double_type, pressio_conversion_explicit); 
+      if(double_result.has_value()) {
+      task_responses.emplace_back(
+          /*task_id*/task_id,
+          /*metric_id*/fieldname_to_id[metric_result.first],
+          /*metric*/double_result.get_value<double>()
+        );
+      }
+    }
+
+    pressio_data_free(decompressed);
+    pressio_data_free(compressed);
+    pressio_options_free(metrics_results);
+    return task_responses;
+  };
+  auto writer = [&](std::vector<ResponseType> const& responses_v){
+    //failed tasks have no metrics to write
+    if(responses_v.empty()) return;
+    int my_task_id;
+    for (auto const& response : responses_v) {
+      auto& [task_id, metric_id, metric] = response;
+      my_task_id = task_id;
+      responses[task_id].set(id_to_fieldname[metric_id], metric);
+    }
+    output_csv(
+        std::cout,
+        task_to_name[my_task_id],
+        &responses[my_task_id],
+        cmdline.fields
+        );
+  };
+
   //do the work
-  queue::work_queue(
-      MPI_COMM_WORLD,
-      std::begin(tasks), std::end(tasks),
-      [&](RequestType request) {
-        auto [task_id, dataset_id, compressor_id] = request;
-        std::vector<ResponseType> task_responses;
-        auto compressor = compressors[compressor_id]->load(library);
-        auto input_data = datasets[dataset_id]->load();
-        auto compressed = pressio_data_new_empty(pressio_byte_dtype, 0, nullptr);
-        auto decompressed = pressio_data_new_clone(input_data);
-
-        pressio_options* configuration_name = pressio_options_new();
-        pressio_options_set_string(configuration_name, "external:config_name", task_to_name[task_id].c_str());
-        pressio_metrics_set_options(metrics, configuration_name);
-        pressio_options_free(configuration_name);
-
-        pressio_compressor_set_metrics(compressor, metrics);
-        pressio_compressor_compress(compressor, input_data, compressed);
-        pressio_compressor_decompress(compressor, compressed, decompressed);
-
-        if(not cmdline.compressed_dir.empty()) {
-          auto compressed_path = cmdline.compressed_dir + "/" + task_to_name[task_id];
-          pressio_io_data_path_write(compressed, compressed_path.c_str());
-        }
-        if(not cmdline.decompressed_dir.empty()) {
-          auto decompressed_path = cmdline.decompressed_dir + "/" + task_to_name[task_id];
-          pressio_io_data_path_write(decompressed, decompressed_path.c_str());
-        }
-
-        auto metrics_results = pressio_compressor_get_metrics_results(compressor);
-        for (auto metric_result : *metrics_results) {
-          auto double_result = metric_result.second.as(pressio_option_double_type, pressio_conversion_explicit); 
-          if(double_result.has_value()) {
-          task_responses.emplace_back(
-              /*task_id*/task_id,
-              /*metric_id*/fieldname_to_id[metric_result.first],
-              /*metric*/double_result.get_value<double>()
-            );
-          }
-        }
-
-        pressio_data_free(input_data);
-        pressio_data_free(decompressed);
-        pressio_data_free(compressed);
-        pressio_compressor_release(compressor);
-        pressio_options_free(metrics_results);
-        return task_responses;
-      },
-      [&](std::vector<ResponseType> const& responses_v){
-        int my_task_id;
-        for (auto const& response : responses_v) {
-          auto& [task_id, metric_id, metric] = response;
-          my_task_id = task_id;
-          responses[task_id].set(id_to_fieldname[metric_id], metric);
-        }
-        output_csv(
-            std::cout,
-            task_to_name[my_task_id],
-            &responses[my_task_id],
-            cmdline.fields
-            );
+  if(cmdline.shared_datasets) {
+    //the window for each dataset is collective over the node, so every rank
+    //works through the datasets together, one at a time
+    MPI_Comm node_comm = split_node_comm(MPI_COMM_WORLD);
+    for (auto begin = std::begin(tasks); begin != std::end(tasks);) {
+      const int dataset_id = std::get<1>(*begin);
+      auto end = std::find_if(begin, std::end(tasks), [dataset_id](RequestType const& task) {
+          return std::get<1>(task) != dataset_id;
+      });
+      std::unique_ptr<shared_dataset> shared;
+      try {
+        shared = std::make_unique<shared_dataset>(MPI_COMM_WORLD, node_comm, *datasets[dataset_id]);
+      } catch(std::exception const& ex) {
+        //every rank fails together, so they all skip this dataset's tasks
+        if(rank == 0) std::cerr << ex.what() << std::endl;
+        begin = end;
+        continue;
       }
-      );
+      node_input = shared->get();
+      queue::work_queue(MPI_COMM_WORLD, begin, end, worker, writer);
+      node_input.reset();
+      shared.reset();
+      begin = end;
+    }
+    MPI_Comm_free(&node_comm);
+  } else {
+    queue::work_queue(MPI_COMM_WORLD, std::begin(tasks), std::end(tasks), worker, writer);
+  }
 
   } catch(std::exception const& e) {
     std::cerr << e.what() << std::endl;
@@ -0,0 +1,105 @@
+#include "shared_dataset.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <libpressio.h>
+
+using namespace std::literals;
+
+namespace {
+/**
+ * describes data as {dtype, dims...}
+ */
+std::vector<uint64_t> describe(pressio_data const* data) {
+  std::vector<uint64_t> description{static_cast<uint64_t>(pressio_data_dtype(data))};
+  for (size_t i = 0; i < pressio_data_num_dimensions(data); ++i) {
+    description.push_back(pressio_data_get_dimension(data, i));
+  }
+  return description;
+}
+
+/**
+ * true on every rank of comm if ok is true on all of them
+ */
+bool all_ranks(MPI_Comm comm, bool ok) {
+  int here = ok, everywhere = 0;
+  MPI_Allreduce(&here, &everywhere, 1, MPI_INT, MPI_MIN, comm);
+  return everywhere;
+}
+}
+
+shared_dataset::shared_dataset(MPI_Comm comm, MPI_Comm node_comm, dataset& source) {
+  int node_rank;
+  MPI_Comm_rank(node_comm, &node_rank);
+
+  //the loading rank describes the dataset as {dtype, dims...}, an empty description means the load failed.
+  //a dataset whose shape is known up front is read straight into the window; otherwise it is
+  //loaded first to learn its shape and copied in
+  pressio_data* loaded = nullptr;
+  std::vector<uint64_t> description;
+  if(node_rank == 0) {
+    if(pressio_data* shape = source.describe()) {
+      description = describe(shape);
+      pressio_data_free(shape);
+    } else if((loaded = source.load())) {
+      description = describe(loaded);
+    }
+  }
+  uint64_t length = description.size();
+  MPI_Bcast(&length, 1, MPI_UINT64_T, 0, node_comm);
+  //every node has to agree, otherwise the ranks of the other nodes would go on to wait for work from this one
+  if(!all_ranks(comm, length != 0)) {
+    pressio_data_free(loaded);
+    throw std::runtime_error("failed to load dataset "s + source.get_name());
+  }
+  description.resize(length);
+  MPI_Bcast(description.data(), static_cast<int>(length), MPI_UINT64_T, 0, node_comm);
+  const auto dtype = static_cast<pressio_dtype>(description.front());
+  std::vector<size_t> dims(std::begin(description) + 1, std::end(description));
+  size_t num_elements = 1;
+  for (auto dim : dims) num_elements *= dim;
+  const size_t size_in_bytes = num_elements * pressio_dtype_size(dtype);
+
+  void* base = nullptr;
+  MPI_Win_allocate_shared((node_rank == 0) ? static_cast<MPI_Aint>(size_in_bytes) : 0, 1, MPI_INFO_NULL, node_comm, &base, &window);
+  MPI_Aint window_size;
+  int disp_unit;
+  MPI_Win_shared_query(window, 0, &window_size, &disp_unit, &base);
+  bool filled = true;
+  if(node_rank == 0) {
+    if(!loaded) {
+      pressio_data* buffer = pressio_data_new_nonowning(dtype, base, dims.size(), dims.data());
+      loaded = source.load_into(buffer);
+      if(loaded != buffer) pressio_data_free(buffer);
+    }
+    //formats that cannot read into the window return their own buffer, which is copied in
+    size_t loaded_bytes = 0;
+    const void* loaded_ptr = loaded ? pressio_data_ptr(loaded, &loaded_bytes) : nullptr;
+    filled = loaded && loaded_bytes == size_in_bytes;
+    if(filled && loaded_bytes && loaded_ptr != base) std::memcpy(base, loaded_ptr, loaded_bytes);
+    pressio_data_free(loaded);
+  }
+  //makes the data visible to the other ranks of the node before they read it
+  MPI_Win_fence(0, window);
+  if(!all_ranks(comm, filled)) {
+    MPI_Win_free(&window);
+    throw std::runtime_error("failed to load dataset "s + source.get_name());
+  }
+
+  view.reset(pressio_data_new_nonowning(dtype, base, dims.size(), dims.data()), pressio_data_free);
+}
+
+shared_dataset::~shared_dataset() {
+  view.reset();
+  if(window != MPI_WIN_NULL) MPI_Win_free(&window);
+}
+
+MPI_Comm split_node_comm(MPI_Comm comm) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm);
+  return node_comm;
+}
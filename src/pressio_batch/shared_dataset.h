@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include <mpi.h>
+#include "datasets.h"
+
+struct pressio_data;
+
+/**
+ * one copy of a dataset per node: the first rank of node_comm loads it into
+ * an MPI-3 shared memory window and every rank of node_comm gets a read-only
+ * non-owning view of it.
+ *
+ * construction is collective over comm, which node_comm is split from, and
+ * throws on every rank of comm if any node failed to load the dataset.
+ * destruction is collective over node_comm, and every view must be released
+ * before destruction.
+ */
+class shared_dataset {
+  public:
+  shared_dataset(MPI_Comm comm, MPI_Comm node_comm, dataset& source);
+  ~shared_dataset();
+  shared_dataset(shared_dataset const&) = delete;
+  shared_dataset& operator=(shared_dataset const&) = delete;
+
+  std::shared_ptr<pressio_data const> const& get() const { return view; }
+
+  private:
+  MPI_Win window = MPI_WIN_NULL;
+  std::shared_ptr<pressio_data const> view;
+};
+
+/**
+ * the ranks of comm that share memory with this rank
+ */
+MPI_Comm split_node_comm(MPI_Comm comm);
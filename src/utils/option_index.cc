@@ -0,0 +1,51 @@
+#include <utils/option_index.h>
+
+option_index::option_index(pressio_options const& options): built(true) {
+  values.reserve(options.size());
+  for (auto const& entry : options) {
+    values.emplace(entry.first, entry.second);
+  }
+}
+
+pressio_options_key_status option_index::key_status(std::string const& key) const {
+  auto it = values.find(key);
+  if(it == values.end()) return pressio_options_key_does_not_exist;
+  return it->second.has_value() ? pressio_options_key_set : pressio_options_key_exists;
+}
+
+pressio_option_type option_index::type(std::string const& key) const {
+  auto it = values.find(key);
+  if(it == values.end()) return pressio_option_unset_type;
+  return it->second.type();
+}
+
+pressio_options_key_status option_index::cast(std::string const& key, pressio_option const& value, pressio_option& out,
+    pressio_conversion_safety safety) const {
+  auto it = values.find(key);
+  if(it == values.end()) return pressio_options_key_does_not_exist;
+  //use pressio_options for the conversion so the rules match cast_set exactly
+  pressio_options single;
+  single.set(key, it->second);
+  auto status = single.cast_set(key, value, safety);
+  if(status == pressio_options_key_set) {
+    out = single.get(key);
+  }
+  return status;
+}
+
+pressio_options option_index::changed(pressio_options const& desired) const {
+  pressio_options changes;
+  for (auto const& entry : desired) {
+    auto it = values.find(entry.first);
+    if(it == values.end() || !(it->second == entry.second)) {
+      changes.set(entry.first, entry.second);
+    }
+  }
+  return changes;
+}
+
+void option_index::update(pressio_options const& options) {
+  for (auto const& entry : options) {
+    values[entry.first] = entry.second;
+  }
+}
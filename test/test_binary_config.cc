@@ -0,0 +1,205 @@
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include <libpressio_ext/cpp/data.h>
+
+#include "binary_config.h"
+
+namespace {
+std::string config_path(std::string const& name) {
+  return ::testing::TempDir() + name + ".pcfg";
+}
+
+std::string read_file(std::string const& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(std::string const& path, std::string const& bytes) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(bytes.data(), bytes.size());
+}
+
+template <class T>
+void append_pod(std::string& out, T const& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void append_string(std::string& out, std::string const& value) {
+  append_pod(out, static_cast<uint64_t>(value.size()));
+  out += value;
+}
+
+uint64_t fnv1a(std::string const& bytes) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : bytes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/** a version 1 configuration whose body is body, with a matching hash */
+std::string make_config_file(std::string const& body) {
+  std::string out("PRESSIOO");
+  append_pod(out, uint32_t{1});
+  append_string(out, "noop");
+  append_string(out, "0.0.0");
+  append_string(out, "0.0.0");
+  append_pod(out, fnv1a(body));
+  append_pod(out, static_cast<uint64_t>(body.size()));
+  return out + body;
+}
+
+binary_config make_config() {
+  binary_config config;
+  config.compressor_id = "noop";
+  config.compressor_version = "1.2.3";
+  config.libpressio_version = "0.99.0";
+  return config;
+}
+
+template <class T>
+T round_trip(T const& value) {
+  const std::string path = config_path("round_trip");
+  binary_config config = make_config();
+  config.options.set("test:value", value);
+  save_binary_config(path, config);
+  auto loaded = load_binary_config(path);
+  EXPECT_TRUE(loaded);
+  EXPECT_EQ(loaded->options.key_status("test:value"), pressio_options_key_set);
+  return loaded->options.get("test:value").template get_value<T>();
+}
+}
+
+TEST(BinaryConfig, RecognizesPath) {
+  EXPECT_TRUE(is_binary_config_path("sz.pcfg"));
+  EXPECT_FALSE(is_binary_config_path("sz.json"));
+  EXPECT_FALSE(is_binary_config_path("pcfg"));
+}
+
+TEST(BinaryConfig, RoundTripsHeader) {
+  const std::string path = config_path("header");
+  save_binary_config(path, make_config());
+  auto loaded = load_binary_config(path);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->compressor_id, "noop");
+  EXPECT_EQ(loaded->compressor_version, "1.2.3");
+  EXPECT_EQ(loaded->libpressio_version, "0.99.0");
+  EXPECT_EQ(loaded->options.size(), 0u);
+}
+
+TEST(BinaryConfig, RoundTripsScalars) {
+  EXPECT_EQ(round_trip<int8_t>(-8), -8);
+  EXPECT_EQ(round_trip<uint8_t>(8), 8u);
+  EXPECT_EQ(round_trip<int16_t>(-16), -16);
+  EXPECT_EQ(round_trip<uint16_t>(16), 16u);
+  EXPECT_EQ(round_trip<int32_t>(-32), -32);
+  EXPECT_EQ(round_trip<uint32_t>(32), 32u);
+  EXPECT_EQ(round_trip<int64_t>(std::numeric_limits<int64_t>::min()), std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(round_trip<uint64_t>(std::numeric_limits<uint64_t>::max()), std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(round_trip<float>(1.5f), 1.5f);
+  EXPECT_EQ(round_trip<double>(1e-300), 1e-300);
+  EXPECT_EQ(round_trip<bool>(true), true);
+  EXPECT_EQ(round_trip<pressio_dtype>(pressio_double_dtype), pressio_double_dtype);
+  EXPECT_EQ(round_trip<pressio_thread_safety>(pressio_thread_safety_multiple), pressio_thread_safety_multiple);
+}
+
+TEST(BinaryConfig, RoundTripsStrings) {
+  EXPECT_EQ(round_trip<std::string>("abs"), "abs");
+  EXPECT_EQ(round_trip<std::string>(""), "");
+  const std::vector<std::string> values{"a", "", "ccc"};
+  EXPECT_EQ(round_trip<std::vector<std::string>>(values), values);
+}
+
+TEST(BinaryConfig, RoundTripsData) {
+  const std::vector<float> values{1, 2, 3, 4, 5, 6};
+  auto data = round_trip<pressio_data>(pressio_data::copy(pressio_float_dtype, values.data(), {2, 3}));
+  EXPECT_EQ(data.dtype(), pressio_float_dtype);
+  EXPECT_EQ(data.dimensions(), (std::vector<size_t>{2, 3}));
+  ASSERT_EQ(data.size_in_bytes(), values.size() * sizeof(float));
+  EXPECT_EQ(std::vector<float>(static_cast<float*>(data.data()), static_cast<float*>(data.data()) + values.size()), values);
+}
+
+TEST(BinaryConfig, SkipsOptionsWithoutValues) {
+  const std::string path = config_path("unset");
+  binary_config config = make_config();
+  config.options.set("test:unset", pressio_option());
+  config.options.set("test:set", int32_t{1});
+  save_binary_config(path, config);
+  auto loaded = load_binary_config(path);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->options.size(), 1u);
+  EXPECT_EQ(loaded->options.key_status("test:unset"), pressio_options_key_does_not_exist);
+}
+
+TEST(BinaryConfig, OtherFilesAreNotBinaryConfigs) {
+  const std::string path = config_path("json");
+  write_file(path, "{\"sz:abs\": 1e-4}");
+  EXPECT_FALSE(load_binary_config(path));
+}
+
+TEST(BinaryConfig, RejectsHashMismatch) {
+  const std::string path = config_path("hash");
+  binary_config config = make_config();
+  config.options.set("test:value", int32_t{7});
+  save_binary_config(path, config);
+  std::string bytes = read_file(path);
+  bytes.back() ^= 1;
+  write_file(path, bytes);
+  EXPECT_THROW(load_binary_config(path), std::runtime_error);
+}
+
+TEST(BinaryConfig, RejectsVersionMismatch) {
+  const std::string path = config_path("version");
+  save_binary_config(path, make_config());
+  std::string bytes = read_file(path);
+  const uint32_t version = 2;
+  bytes.replace(8, sizeof(version), reinterpret_cast<const char*>(&version), sizeof(version));
+  write_file(path, bytes);
+  EXPECT_THROW(load_binary_config(path), std::runtime_error);
+}
+
+TEST(BinaryConfig, RejectsTruncatedBody) {
+  const std::string path = config_path("truncated");
+  binary_config config = make_config();
+  config.options.set("test:value", std::string("abs"));
+  save_binary_config(path, config);
+  std::string bytes = read_file(path);
+  bytes.resize(bytes.size() - 2);
+  write_file(path, bytes);
+  EXPECT_THROW(load_binary_config(path), std::runtime_error);
+}
+
+TEST(BinaryConfig, RejectsCountsPastTheEnd) {
+  //the hash matches, so only the count check stands between the count and an allocation
+  const uint64_t huge = uint64_t{1} << 60;
+  std::string strings;
+  append_pod(strings, uint64_t{1});
+  append_string(strings, "test:strings");
+  append_pod(strings, pressio_option_charptr_array_type);
+  append_pod(strings, huge);
+
+  std::string dims;
+  append_pod(dims, uint64_t{1});
+  append_string(dims, "test:data");
+  append_pod(dims, pressio_option_data_type);
+  append_pod(dims, static_cast<int32_t>(pressio_float_dtype));
+  append_pod(dims, huge);
+
+  for (auto const& body : {strings, dims}) {
+    const std::string path = config_path("counts");
+    write_file(path, make_config_file(body));
+    try {
+      load_binary_config(path);
+      ADD_FAILURE() << "expected an exception";
+    } catch(std::runtime_error const& ex) {
+      EXPECT_STREQ(ex.what(), "truncated binary configuration");
+    }
+  }
+}
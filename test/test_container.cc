@@ -0,0 +1,97 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "container.h"
+
+namespace {
+container_header make_header() {
+  container_header header;
+  header.dtype = pressio_float_dtype;
+  header.dims = {4, 10};
+  header.block_extent = 3;
+  header.compressor_id = "noop";
+  header.compressor_options = "{}";
+  return header;
+}
+
+std::vector<pressio_data> make_blocks() {
+  std::vector<pressio_data> blocks;
+  for (size_t b = 0; b < 4; ++b) {
+    std::string bytes(b + 2, static_cast<char>('a' + b));
+    blocks.emplace_back(pressio_data::copy(pressio_byte_dtype, bytes.data(), {bytes.size()}));
+  }
+  return blocks;
+}
+
+std::string block_string(pressio_data const& block) {
+  return std::string(static_cast<const char*>(block.data()), block.size_in_bytes());
+}
+
+std::string container_bytes(pressio_data const& container) {
+  return std::string(static_cast<const char*>(container.data()), container.size_in_bytes());
+}
+
+pressio_data bytes_to_data(std::string const& bytes) {
+  return pressio_data::copy(pressio_byte_dtype, bytes.data(), {bytes.size()});
+}
+}
+
+TEST(ContainerTests, RoundTrip) {
+  auto blocks = make_blocks();
+  pressio_data packed = pack_container(make_header(), blocks);
+  ASSERT_TRUE(is_container(packed));
+
+  container_view view(packed);
+  EXPECT_EQ(view.header().dtype, pressio_float_dtype);
+  EXPECT_EQ(view.header().dims, (std::vector<size_t>{4, 10}));
+  EXPECT_EQ(view.header().block_extent, 3);
+  EXPECT_EQ(view.header().compressor_id, "noop");
+  EXPECT_EQ(view.header().compressor_options, "{}");
+  ASSERT_EQ(view.num_blocks(), blocks.size());
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    EXPECT_EQ(block_string(view.block(b)), block_string(blocks[b]));
+  }
+}
+
+TEST(ContainerTests, RandomAccess) {
+  pressio_data packed = pack_container(make_header(), make_blocks());
+  container_view view(packed);
+  EXPECT_EQ(block_string(view.block(2)), "cccc");
+  EXPECT_EQ(view.block_start(2), 6);
+  EXPECT_EQ(view.block_count(2), 3);
+  EXPECT_EQ(view.block_start(3), 9);
+  EXPECT_EQ(view.block_count(3), 1);
+  EXPECT_THROW(view.block(4), std::out_of_range);
+}
+
+TEST(ContainerTests, RejectsTruncatedTrailer) {
+  std::string bytes = container_bytes(pack_container(make_header(), make_blocks()));
+  bytes.resize(bytes.size() - 3);
+  EXPECT_THROW(container_view{bytes_to_data(bytes)}, std::runtime_error);
+}
+
+TEST(ContainerTests, RejectsBadMagic) {
+  std::string bytes = container_bytes(pack_container(make_header(), make_blocks()));
+  bytes[0] = 'X';
+  pressio_data data = bytes_to_data(bytes);
+  EXPECT_FALSE(is_container(data));
+  EXPECT_THROW(container_view{data}, std::runtime_error);
+}
+
+TEST(ContainerTests, RejectsIndexOffsetPastEnd) {
+  std::string bytes = container_bytes(pack_container(make_header(), make_blocks()));
+  const uint64_t past_end = bytes.size() + 1;
+  //the trailer is the index offset followed by the magic
+  std::memcpy(&bytes[bytes.size() - 16], &past_end, sizeof(past_end));
+  EXPECT_THROW(container_view{bytes_to_data(bytes)}, std::runtime_error);
+}
+
+TEST(ContainerTests, RejectsMismatchedBlockCount) {
+  auto blocks = make_blocks();
+  blocks.pop_back();
+  pressio_data packed = pack_container(make_header(), blocks);
+  EXPECT_THROW(container_view{packed}, std::runtime_error);
+}
@@ -0,0 +1,48 @@
+#include <numeric>
+#include "gtest/gtest.h"
+
+#include "utils/hyperslab.h"
+
+TEST(HyperslabTests, ParseAndResolve) {
+  auto ranges = parse_hyperslab("1:3,:,2:");
+  ASSERT_EQ(ranges.size(), 3);
+  auto slab = resolve_hyperslab(ranges, {4, 5, 6});
+  EXPECT_EQ(slab.start, (std::vector<size_t>{1, 0, 2}));
+  EXPECT_EQ(slab.count, (std::vector<size_t>{2, 5, 4}));
+
+  auto partial = resolve_hyperslab(parse_hyperslab("0:1"), {4, 5});
+  EXPECT_EQ(partial.start, (std::vector<size_t>{0, 0}));
+  EXPECT_EQ(partial.count, (std::vector<size_t>{1, 5}));
+}
+
+TEST(HyperslabTests, InvalidRanges) {
+  EXPECT_THROW(parse_hyperslab("1"), std::invalid_argument);
+  EXPECT_THROW(parse_hyperslab("1x:2"), std::invalid_argument);
+  EXPECT_THROW(resolve_hyperslab(parse_hyperslab("3:2"), {4}), std::out_of_range);
+  EXPECT_THROW(resolve_hyperslab(parse_hyperslab("0:5"), {4}), std::out_of_range);
+  EXPECT_THROW(resolve_hyperslab(parse_hyperslab(":,:"), {4}), std::out_of_range);
+}
+
+TEST(HyperslabTests, CopyBox) {
+  std::vector<int> src(4 * 3 * 2);
+  std::iota(src.begin(), src.end(), 0);
+  std::vector<int> dst(2 * 2 * 1, -1);
+  copy_hyperslab(src.data(), {4, 3, 2}, {1, 1, 1}, dst.data(), {2, 2, 1}, {0, 0, 0}, {2, 2, 1}, sizeof(int));
+  EXPECT_EQ(dst, (std::vector<int>{17, 18, 21, 22}));
+}
+
+TEST(HyperslabTests, Partition) {
+  hyperslab whole{{0, 2}, {4, 10}};
+  std::vector<size_t> counts;
+  for (size_t part = 0; part < 4; ++part) {
+    auto piece = partition_hyperslab(whole, part, 4);
+    EXPECT_EQ(piece.count[0], 4);
+    EXPECT_EQ(piece.start[1], 2 + std::min<size_t>(part * 3, 10));
+    counts.push_back(piece.count[1]);
+  }
+  EXPECT_EQ(counts, (std::vector<size_t>{3, 3, 3, 1}));
+
+  hyperslab small{{0}, {5}};
+  EXPECT_EQ(partition_hyperslab(small, 3, 4).count[0], 0);
+  EXPECT_EQ(partition_hyperslab(small, 2, 4).count[0], 1);
+}
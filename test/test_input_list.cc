@@ -0,0 +1,95 @@
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "input_list.h"
+
+namespace {
+std::string write_list(std::string const& name, std::string const& contents) {
+  const std::string path = ::testing::TempDir() + name + ".list";
+  std::ofstream out(path, std::ios::trunc);
+  out << contents;
+  return path;
+}
+
+/** the message load_input_list throws for path, or "" if it succeeds */
+std::string load_error(std::string const& path) {
+  try {
+    load_input_list(path);
+  } catch(std::runtime_error const& ex) {
+    return ex.what();
+  }
+  return "";
+}
+}
+
+TEST(InputList, ReadsEveryField) {
+  auto entries = load_input_list(write_list("fields",
+        "input=a.bin dtype=float dims=4,5,6 format=posix compressed=a.sz compressed_format=posix "
+        "decompressed=a.out decompressed_format=posix\n"));
+  ASSERT_EQ(entries.size(), 1u);
+  auto const& entry = entries.front();
+  EXPECT_EQ(entry.input, "a.bin");
+  EXPECT_EQ(entry.dtype, std::string("float"));
+  EXPECT_EQ(entry.dims, (std::vector<size_t>{4, 5, 6}));
+  EXPECT_EQ(entry.format, std::string("posix"));
+  EXPECT_EQ(entry.compressed, std::string("a.sz"));
+  EXPECT_EQ(entry.compressed_format, std::string("posix"));
+  EXPECT_EQ(entry.decompressed, std::string("a.out"));
+  EXPECT_EQ(entry.decompressed_format, std::string("posix"));
+}
+
+TEST(InputList, UnsetFieldsStayUnset) {
+  auto entries = load_input_list(write_list("unset", "input=a.bin\n"));
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_FALSE(entries.front().dtype);
+  EXPECT_TRUE(entries.front().dims.empty());
+  EXPECT_FALSE(entries.front().compressed);
+}
+
+TEST(InputList, SkipsCommentsAndBlankLines) {
+  auto entries = load_input_list(write_list("comments",
+        "# inputs\n"
+        "\n"
+        "input=a.bin\n"
+        "   \t\r\n"
+        "  # indented comment\n"
+        "input=b.bin   dims=2\r\n"));
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].input, "a.bin");
+  EXPECT_EQ(entries[1].input, "b.bin");
+  EXPECT_EQ(entries[1].dims, std::vector<size_t>{2});
+}
+
+TEST(InputList, EmptyListHasNoEntries) {
+  EXPECT_TRUE(load_input_list(write_list("empty", "# nothing\n")).empty());
+}
+
+TEST(InputList, RejectsBadDims) {
+  for (std::string dims : {"4,x", "4x", "4,,5", "-1", "4,-1"}) {
+    const std::string path = write_list("dims", "input=a.bin dims=" + dims + "\n");
+    EXPECT_EQ(load_error(path), path + ":1: invalid dims " + dims) << dims;
+  }
+}
+
+TEST(InputList, RejectsUnknownKeys) {
+  const std::string path = write_list("unknown", "input=a.bin\ninput=b.bin shape=4\n");
+  EXPECT_EQ(load_error(path), path + ":2: unknown key shape");
+}
+
+TEST(InputList, RejectsFieldsWithoutValues) {
+  const std::string path = write_list("novalue", "input=a.bin float\n");
+  EXPECT_EQ(load_error(path), path + ":1: expected key=value, got float");
+}
+
+TEST(InputList, RequiresInput) {
+  const std::string path = write_list("noinput", "# header\n\ndtype=float dims=4\n");
+  EXPECT_EQ(load_error(path), path + ":3: every input requires input=<path>");
+}
+
+TEST(InputList, RejectsMissingFile) {
+  const std::string path = ::testing::TempDir() + "does_not_exist.list";
+  EXPECT_EQ(load_error(path), "failed to open " + path);
+}
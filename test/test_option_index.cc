@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include "utils/option_index.h"
+
+#include <vector>
+
+TEST(OptionIndexTests, Cast) {
+  pressio_options options;
+  options.set("test:int", int32_t{1});
+  options.set("test:double", 1.0);
+  option_index index(options);
+  ASSERT_TRUE(index.indexed());
+
+  pressio_option out;
+  EXPECT_EQ(index.cast("test:int", std::string("3"), out), pressio_options_key_set);
+  EXPECT_EQ(out.type(), pressio_option_int32_type);
+  EXPECT_EQ(out.get_value<int32_t>(), 3);
+  EXPECT_EQ(index.cast("test:missing", std::string("3"), out), pressio_options_key_does_not_exist);
+  EXPECT_EQ(index.type("test:double"), pressio_option_double_type);
+}
+
+TEST(OptionIndexTests, ChangedAndUpdate) {
+  pressio_options options;
+  options.set("test:a", int32_t{1});
+  options.set("test:b", int32_t{2});
+  option_index index(options);
+
+  pressio_options desired;
+  desired.set("test:a", int32_t{1});
+  desired.set("test:b", int32_t{5});
+  auto changes = index.changed(desired);
+  EXPECT_EQ(changes.size(), 1);
+  EXPECT_EQ(changes.key_status("test:b"), pressio_options_key_set);
+
+  index.update(changes);
+  EXPECT_EQ(index.changed(desired).size(), 0);
+}
+
+namespace {
+struct recording_configurable {
+  int set_options(pressio_options const& options) {
+    applied.push_back(options.size());
+    return 0;
+  }
+  std::vector<size_t> applied;
+};
+}
+
+TEST(OptionIndexTests, ApplyOptionsSetsUnchangedKeys) {
+  pressio_options options;
+  options.set("test:a", int32_t{1});
+  options.set("test:b", int32_t{2});
+  option_index index(options);
+  recording_configurable configurable;
+
+  pressio_options desired;
+  desired.set("test:a", int32_t{1});
+  desired.set("test:b", int32_t{5});
+  EXPECT_EQ(apply_options(configurable, desired, index), 0);
+  EXPECT_EQ(apply_changed_options(configurable, desired, index), 0);
+  ASSERT_EQ(configurable.applied.size(), 1);
+  EXPECT_EQ(configurable.applied.front(), 2);
+}
@@ -0,0 +1,117 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "pipeline.h"
+
+namespace {
+void wait_briefly() {
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+}
+
+TEST(BoundedQueue, PushBlocksWhileFull) {
+  bounded_queue<int> queue(2);
+  ASSERT_TRUE(queue.push(1));
+  ASSERT_TRUE(queue.push(2));
+
+  std::atomic<bool> pushed{false};
+  std::thread producer([&]{
+    EXPECT_TRUE(queue.push(3));
+    pushed = true;
+  });
+  wait_briefly();
+  EXPECT_FALSE(pushed);
+
+  EXPECT_EQ(*queue.pop(), 1);
+  producer.join();
+  EXPECT_TRUE(pushed);
+  EXPECT_EQ(*queue.pop(), 2);
+  EXPECT_EQ(*queue.pop(), 3);
+}
+
+TEST(BoundedQueue, CloseReleasesBlockedProducer) {
+  bounded_queue<int> queue(1);
+  ASSERT_TRUE(queue.push(1));
+
+  std::atomic<bool> result{true};
+  std::thread producer([&]{ result = queue.push(2); });
+  wait_briefly();
+  queue.close();
+  producer.join();
+  EXPECT_FALSE(result);
+  EXPECT_FALSE(queue.push(3));
+}
+
+TEST(BoundedQueue, PopDrainsThenReturnsNulloptAfterClose) {
+  bounded_queue<int> queue(4);
+  queue.push(1);
+  queue.push(2);
+  queue.close();
+  EXPECT_EQ(*queue.pop(), 1);
+  EXPECT_EQ(*queue.pop(), 2);
+  EXPECT_FALSE(queue.pop());
+  EXPECT_FALSE(queue.pop());
+}
+
+TEST(BoundedQueue, CloseReleasesBlockedConsumer) {
+  bounded_queue<int> queue(1);
+  std::atomic<bool> got_item{true};
+  std::thread consumer([&]{ got_item = static_cast<bool>(queue.pop()); });
+  wait_briefly();
+  queue.close();
+  consumer.join();
+  EXPECT_FALSE(got_item);
+}
+
+TEST(RunPipeline, KeepsResultsInOrder) {
+  const size_t n = 100;
+  std::vector<size_t> written;
+  run_pipeline(n, 3,
+      [](size_t i) { return i; },
+      [](size_t, size_t value) { return value * 2; },
+      [&](size_t i, size_t value) {
+        EXPECT_EQ(value, i * 2);
+        written.push_back(i);
+      });
+  ASSERT_EQ(written.size(), n);
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(written[i], i);
+  }
+}
+
+TEST(RunPipeline, RespectsDepth) {
+  //at most depth items wait in each of the two queues plus one held by each stage
+  const size_t n = 50, depth = 2;
+  std::atomic<size_t> read{0}, written{0}, most_in_flight{0};
+  run_pipeline(n, depth,
+      [&](size_t i) {
+        const size_t in_flight = ++read - written;
+        size_t most = most_in_flight;
+        while(in_flight > most && !most_in_flight.compare_exchange_weak(most, in_flight)) {}
+        return i;
+      },
+      [](size_t, size_t value) { return value; },
+      [&](size_t, size_t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++written;
+      });
+  EXPECT_EQ(written, n);
+  EXPECT_LE(most_in_flight, 2 * depth + 3);
+}
+
+TEST(RunPipeline, RethrowsStageErrors) {
+  std::atomic<size_t> written{0};
+  EXPECT_THROW(run_pipeline(100, 2,
+      [](size_t i) { return i; },
+      [](size_t i, size_t value) {
+        if(i == 10) throw std::runtime_error("process failed");
+        return value;
+      },
+      [&](size_t, size_t) { ++written; }),
+    std::runtime_error);
+  EXPECT_LE(written, 10u);
+}
@@ -39,10 +39,32 @@ TEST_P(TrieTests, TestMatches) {
   }
 }
 
+TEST_P(TrieTests, TestFlatTrieMatches) {
+  {
+    static constexpr std::array<std::string_view, 3> flat_candidates{"fooz", "bar", "foobar"};
+    static constexpr auto trie = make_flat_trie<trie_capacity(flat_candidates)>(flat_candidates);
+    auto& [test, expected] = GetParam();
+    EXPECT_EQ(fuzzy_match(test, trie), expected);
+  }
+}
+
+TEST(TrieTests, ConstexprTrie) {
+  static constexpr std::array<std::string_view, 3> candidates{"fooz", "bar", "foobar"};
+  constexpr auto trie = make_flat_trie<trie_capacity(candidates)>(candidates);
+  static_assert(trie.size() == 3, "every candidate is inserted");
+  static_assert(trie.find("b") == 1, "unique prefixes match");
+  static_assert(trie.find("foob") == 2, "unique prefixes match");
+  static_assert(trie.find("foo") == decltype(trie)::npos, "ambiguous prefixes do not match");
+  static_assert(trie.find("x") == decltype(trie)::npos, "unknown prefixes do not match");
+}
+
 TEST(TrieTests, InvalidCandidates) {
   std::vector<std::string> candidates{"foo", "foobar"};
   EXPECT_THROW(fuzzy_match("ignored", std::begin(candidates), std::end(candidates)), std::logic_error);
   EXPECT_THROW(fuzzy_match("ignored", std::rbegin(candidates), std::rend(candidates)), std::logic_error);
+
+  std::vector<std::string> duplicates{"foo", "foo"};
+  EXPECT_THROW(fuzzy_match("ignored", std::begin(duplicates), std::end(duplicates)), std::logic_error);
 }
 
 INSTANTIATE_TEST_SUITE_P(TrieAllCorrectnessTests,